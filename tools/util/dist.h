@@ -1,12 +1,34 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <limits>
+#include <span>
 #include <stdexcept>
 #include <type_traits>
+#include <vector>
+
+namespace dist_detail {
+// Lemire's multiply-shift: the high half of g() * range, redrawn while the low half is below
+// threshold == 2^N mod range. Narrow is the engine's result width, Wide twice that.
+template <class Wide, class Narrow, class Gen>
+Narrow LemireDraw(Gen& g, Narrow range, Narrow threshold) {
+    Wide product = static_cast<Wide>(static_cast<Narrow>(g())) * range;
+    while (static_cast<Narrow>(product) < threshold) {
+        product = static_cast<Wide>(static_cast<Narrow>(g())) * range;
+    }
+    return static_cast<Narrow>(
+        product >> static_cast<uint64_t>(std::numeric_limits<Narrow>::digits));
+}
+
+template <class Gen, class Narrow>
+inline constexpr bool kFullRangeEngine =
+    Gen::min() == 0 && Gen::max() == std::numeric_limits<Narrow>::max();
+}  // namespace dist_detail
 
 template <typename IntType = int>
 class UniformIntDistribution {
@@ -25,6 +47,11 @@ class UniformIntDistribution {
         return this->operator()(gen, a_, b_);
     }
 
+    // Same values as out.size() calls of operator(), with the range and the rejection
+    // threshold computed once for the whole span.
+    template <class Gen>
+    void Fill(std::span<IntType> out, Gen& gen);
+
    private:
     IntType a_;
     IntType b_;
@@ -110,7 +137,93 @@ IntType UniformIntDistribution<IntType>::operator()(Gen& urng, IntType a, IntTyp
     return ret + a;
 }
 
-template <class RealType = double>
+template <class IntType>
+template <class Gen>
+void UniformIntDistribution<IntType>::Fill(std::span<IntType> out, Gen& urng) {
+    using UType = std::make_unsigned_t<IntType>;
+    using UCType = std::common_type_t<typename Gen::result_type, UType>;
+    const UCType urange = static_cast<UCType>(b_) - static_cast<UCType>(a_);
+    if constexpr (dist_detail::kFullRangeEngine<Gen, uint32_t>) {
+        if (urange < std::numeric_limits<uint32_t>::max()) {
+            const auto range = static_cast<uint32_t>(urange + 1);
+            const uint32_t threshold = (0U - range) % range;
+            for (auto& value : out) {
+                const UCType draw = dist_detail::LemireDraw<uint64_t>(urng, range, threshold);
+                value = static_cast<IntType>(draw + static_cast<UCType>(a_));
+            }
+            return;
+        }
+    } else if constexpr (dist_detail::kFullRangeEngine<Gen, uint64_t>) {
+        if (urange < std::numeric_limits<uint64_t>::max()) {
+            const auto range = static_cast<uint64_t>(urange + 1);
+            const uint64_t threshold = (0ULL - range) % range;
+            for (auto& value : out) {
+                const UCType draw = __extension__ dist_detail::LemireDraw<unsigned __int128>(
+                    urng, range, threshold);
+                value = static_cast<IntType>(draw + static_cast<UCType>(a_));
+            }
+            return;
+        }
+    }
+    for (auto& value : out) {
+        value = this->operator()(urng);
+    }
+}
+
+// UniformIntDistribution with bounds known at compile time: the range and the rejection
+// threshold are constants, so a draw is one multiplication and a compare that is almost
+// never taken. Produces the same values as UniformIntDistribution{From, To}.
+template <auto From, auto To>
+class FixedUniformIntDistribution {
+   public:
+    using IntType = decltype(From);
+    static_assert(std::is_integral_v<IntType>, "bounds must be integral");
+    static_assert(std::is_same_v<IntType, decltype(To)>, "bounds must have the same type");
+    static_assert(From <= To, "empty range");
+
+    template <class Gen>
+    IntType operator()(Gen& gen) const {
+        using UCType = Common<Gen>;
+        constexpr UCType kUrange = static_cast<UCType>(To) - static_cast<UCType>(From);
+        if constexpr (
+            dist_detail::kFullRangeEngine<Gen, uint32_t> &&
+            kUrange < std::numeric_limits<uint32_t>::max()) {
+            constexpr auto kRange = static_cast<uint32_t>(kUrange + 1);
+            constexpr uint32_t kThreshold = (0U - kRange) % kRange;
+            const UCType draw = dist_detail::LemireDraw<uint64_t>(gen, kRange, kThreshold);
+            return static_cast<IntType>(draw + static_cast<UCType>(From));
+        } else if constexpr (
+            dist_detail::kFullRangeEngine<Gen, uint64_t> &&
+            kUrange < std::numeric_limits<uint64_t>::max()) {
+            constexpr auto kRange = static_cast<uint64_t>(kUrange + 1);
+            constexpr uint64_t kThreshold = (0ULL - kRange) % kRange;
+            const UCType draw = __extension__ dist_detail::LemireDraw<unsigned __int128>(
+                gen, kRange, kThreshold);
+            return static_cast<IntType>(draw + static_cast<UCType>(From));
+        } else {
+            return UniformIntDistribution<IntType>{From, To}(gen);
+        }
+    }
+
+    template <class Gen>
+    void Fill(std::span<IntType> out, Gen& gen) const {
+        for (auto& value : out) {
+            value = this->operator()(gen);
+        }
+    }
+
+   private:
+    template <class Gen>
+    using Common = std::common_type_t<typename Gen::result_type, std::make_unsigned_t<IntType>>;
+};
+
+// kPortable is the generate_canonical algorithm: enough engine outputs to cover the mantissa,
+// combined in floating point. kFast53 takes the top `digits` bits of one 64-bit draw (two
+// draws of a 32-bit engine) and scales them by 2^-digits, which is exact and branch-free;
+// engines without a full 32- or 64-bit range use kPortable either way.
+enum class CanonicalMode { kPortable, kFast53 };
+
+template <class RealType = double, CanonicalMode Mode = CanonicalMode::kPortable>
 class UniformRealDistribution {
    public:
     static_assert(std::is_floating_point_v<RealType>, "result_type must be a floating point type");
@@ -122,30 +235,412 @@ class UniformRealDistribution {
     }
 
     RealType operator()(auto& urng) {
-        return GenerateCanonical(urng) * (b_ - a_) + a_;
+        return Generate(urng) * (b_ - a_) + a_;
+    }
+
+    // Same values as out.size() calls of operator().
+    template <class Gen>
+    void Fill(std::span<RealType> out, Gen& urng) {
+        const RealType scale = b_ - a_;
+        for (auto& value : out) {
+            value = Generate(urng) * scale + a_;
+        }
     }
 
    private:
+    static constexpr auto kBits = std::numeric_limits<RealType>::digits;
+
+    // Engine-dependent constants of GenerateCanonical: the engine range R, the number of draws
+    // m = ceil(digits / floor(log2 R)) and the powers R^0 .. R^m in RealType.
+    template <class Gen>
+    struct Canonical {
+        static constexpr uintmax_t kRangeMinusOne =
+            static_cast<uintmax_t>(Gen::max()) - static_cast<uintmax_t>(Gen::min());
+        static constexpr auto kR = static_cast<long double>(kRangeMinusOne) + 1.L;
+        static constexpr size_t kLog2R =
+            kRangeMinusOne == std::numeric_limits<uintmax_t>::max()
+                ? std::numeric_limits<uintmax_t>::digits
+                : std::bit_width(kRangeMinusOne + 1) - 1;
+        static constexpr size_t kDraws = std::max<size_t>(1UL, (kBits + kLog2R - 1UL) / kLog2R);
+        static constexpr std::array<RealType, kDraws + 1> kPowers = [] {
+            std::array<RealType, kDraws + 1> powers{};
+            RealType tmp{1};
+            for (auto& power : powers) {
+                power = tmp;
+                tmp *= kR;
+            }
+            return powers;
+        }();
+    };
+
+    template <class Gen>
+    static RealType Generate(Gen& urng) {
+        if constexpr (Mode == CanonicalMode::kFast53) {
+            return GenerateFast(urng);
+        } else {
+            return GenerateCanonical(urng);
+        }
+    }
+
     template <class Gen>
     static RealType GenerateCanonical(Gen& urng) {
-        constexpr auto kBits = std::numeric_limits<RealType>::digits;
-        constexpr auto kR =
-            static_cast<long double>(Gen::max()) - static_cast<long double>(Gen::min()) + 1.L;
-        const size_t log2r = std::log(kR) / std::log(2.L);
-        const size_t m = std::max<size_t>(1UL, (kBits + log2r - 1UL) / log2r);
+        using Constants = Canonical<Gen>;
         RealType sum{0};
-        RealType tmp{1};
-        for (auto k = m; k != 0; --k) {
-            sum += static_cast<RealType>(urng() - urng.min()) * tmp;
-            tmp *= kR;
+        for (size_t k = 0; k < Constants::kDraws; ++k) {
+            sum += static_cast<RealType>(urng() - urng.min()) * Constants::kPowers[k];
         }
-        RealType ret = sum / tmp;
+        RealType ret = sum / Constants::kPowers[Constants::kDraws];
         if (ret >= RealType{1}) {
             return std::nextafter(RealType{1}, RealType{0});
         }
         return ret;
     }
 
+    template <class Gen>
+    static RealType GenerateFast(Gen& urng) {
+        static_assert(kBits <= 64, "the fast mode fills at most 64 mantissa bits");
+        constexpr RealType kUlp = [] {
+            RealType ulp{1};
+            for (int i = 0; i < kBits; ++i) {
+                ulp /= 2;
+            }
+            return ulp;
+        }();
+        if constexpr (dist_detail::kFullRangeEngine<Gen, uint32_t> && kBits <= 32) {
+            const auto bits = static_cast<uint32_t>(urng());
+            return static_cast<RealType>(bits >> (32 - kBits)) * kUlp;
+        } else if constexpr (dist_detail::kFullRangeEngine<Gen, uint32_t>) {
+            const auto high = static_cast<uint64_t>(static_cast<uint32_t>(urng()));
+            const auto bits = (high << 32U) | static_cast<uint32_t>(urng());
+            return static_cast<RealType>(bits >> (64 - kBits)) * kUlp;
+        } else if constexpr (dist_detail::kFullRangeEngine<Gen, uint64_t>) {
+            const auto bits = static_cast<uint64_t>(urng());
+            return static_cast<RealType>(bits >> (64 - kBits)) * kUlp;
+        } else {
+            return GenerateCanonical(urng);
+        }
+    }
+
     RealType a_;
     RealType b_;
 };
+
+template <class RealType = double>
+using FastUniformRealDistribution = UniformRealDistribution<RealType, CanonicalMode::kFast53>;
+
+// The distributions below consume only raw engine bits and the helpers in dist_detail, never
+// the implementation-defined std:: distributions, so their algorithms do not change with the
+// standard library. Their values still go through libm (exp, log, log1p, expm1, sqrt in the
+// Ziggurat tables, the accept tests and Zipf), whose last-bit rounding may differ between
+// platforms; a seed is only guaranteed to repeat its values on the same platform.
+namespace dist_detail {
+// 64 random bits: one draw of a 64-bit engine, two of a 32-bit one (high half first).
+template <class Gen>
+uint64_t Bits64(Gen& gen) {
+    if constexpr (kFullRangeEngine<Gen, uint64_t>) {
+        return static_cast<uint64_t>(gen());
+    } else if constexpr (kFullRangeEngine<Gen, uint32_t>) {
+        const auto high = static_cast<uint64_t>(static_cast<uint32_t>(gen()));
+        return (high << 32U) | static_cast<uint32_t>(gen());
+    } else {
+        return UniformIntDistribution<uint64_t>{0}(gen);
+    }
+}
+
+constexpr double kTwoMinus53 = 1.0 / static_cast<double>(uint64_t{1} << 53U);
+
+// Uniform on [0, 1) from the top 53 bits.
+inline double OpenAbove(uint64_t bits) {
+    return static_cast<double>(bits >> 11U) * kTwoMinus53;
+}
+
+// Uniform on (0, 1], safe to take the logarithm of.
+inline double OpenBelow(uint64_t bits) {
+    return static_cast<double>((bits >> 11U) + 1) * kTwoMinus53;
+}
+
+// Ziggurat of N layers of equal area v under a decreasing density f on [0, inf) with tail
+// start r (Marsaglia and Tsang, "The Ziggurat Method for Generating Random Variables").
+// x[0] is the width of the base strip stretched to a rectangle, x[1] = r, x[N] = 0, and
+// y[i] = f(x[i]).
+template <size_t N>
+struct Ziggurat {
+    std::array<double, N + 1> x;
+    std::array<double, N + 1> y;
+
+    template <class Density, class Inverse>
+    Ziggurat(double r, double v, Density f, Inverse f_inverse) {
+        x[0] = v / f(r);
+        x[1] = r;
+        for (size_t i = 1; i + 1 < N; ++i) {
+            x[i + 1] = f_inverse(f(x[i]) + v / x[i]);
+        }
+        x[N] = 0;
+        for (size_t i = 0; i < N; ++i) {
+            y[i] = f(x[i]);
+        }
+        y[0] = 0;
+        y[N] = 1;
+    }
+};
+
+inline const Ziggurat<256>& NormalZiggurat() {
+    static const Ziggurat<256> kTable{
+        3.6541528853610088, 0.00492867323399, [](double x) { return std::exp(-0.5 * x * x); },
+        [](double y) { return std::sqrt(-2 * std::log(y)); }};
+    return kTable;
+}
+
+inline const Ziggurat<256>& ExponentialZiggurat() {
+    static const Ziggurat<256> kTable{
+        7.69711747013104972, 0.0039496598225815571993, [](double x) { return std::exp(-x); },
+        [](double y) { return -std::log(y); }};
+    return kTable;
+}
+}  // namespace dist_detail
+
+// Normal distribution by the 256-layer Ziggurat: one 64-bit draw supplies the layer (bits
+// 0-7), the sign (bit 8) and a 53-bit uniform (bits 11-63), and ~99% of samples are a
+// multiplication and a compare.
+template <class RealType = double>
+class NormalDistribution {
+   public:
+    static_assert(std::is_floating_point_v<RealType>, "result_type must be a floating point type");
+
+    explicit NormalDistribution(RealType mean = 0, RealType stddev = 1)  // NOLINT
+        : mean_{mean}, stddev_{stddev}, table_{&dist_detail::NormalZiggurat()} {
+    }
+
+    template <class Gen>
+    RealType operator()(Gen& gen) {
+        return static_cast<RealType>(Standard(gen)) * stddev_ + mean_;
+    }
+
+   private:
+    static constexpr double kTail = 3.6541528853610088;
+
+    template <class Gen>
+    double Standard(Gen& gen) const {
+        while (true) {
+            const uint64_t bits = dist_detail::Bits64(gen);
+            const size_t layer = bits & 0xFF;
+            const bool negative = ((bits >> 8U) & 1) != 0;
+            double x = dist_detail::OpenAbove(bits) * table_->x[layer];
+            if (x < table_->x[layer + 1]) {
+                return negative ? -x : x;
+            }
+            if (layer == 0) {
+                // Tail beyond kTail, by Marsaglia's exponential rejection.
+                double tail = 0;
+                double y = 0;
+                do {  // NOLINT(cppcoreguidelines-avoid-do-while)
+                    tail = -std::log(dist_detail::OpenBelow(dist_detail::Bits64(gen))) / kTail;
+                    y = -std::log(dist_detail::OpenBelow(dist_detail::Bits64(gen)));
+                } while (y + y < tail * tail);
+                x = kTail + tail;
+                return negative ? -x : x;
+            }
+            const double y =
+                table_->y[layer] + dist_detail::OpenAbove(dist_detail::Bits64(gen)) *
+                                      (table_->y[layer + 1] - table_->y[layer]);
+            if (y < std::exp(-0.5 * x * x)) {
+                return negative ? -x : x;
+            }
+        }
+    }
+
+    RealType mean_;
+    RealType stddev_;
+    const dist_detail::Ziggurat<256>* table_;
+};
+
+// Exponential distribution with rate lambda by the 256-layer Ziggurat.
+template <class RealType = double>
+class ExponentialDistribution {
+   public:
+    static_assert(std::is_floating_point_v<RealType>, "result_type must be a floating point type");
+
+    explicit ExponentialDistribution(RealType lambda = 1)  // NOLINT
+        : inverse_lambda_{1 / lambda}, table_{&dist_detail::ExponentialZiggurat()} {
+    }
+
+    template <class Gen>
+    RealType operator()(Gen& gen) {
+        return static_cast<RealType>(Standard(gen)) * inverse_lambda_;
+    }
+
+   private:
+    static constexpr double kTail = 7.69711747013104972;
+
+    template <class Gen>
+    double Standard(Gen& gen) const {
+        double offset = 0;
+        while (true) {
+            const uint64_t bits = dist_detail::Bits64(gen);
+            const size_t layer = bits & 0xFF;
+            const double x = dist_detail::OpenAbove(bits) * table_->x[layer];
+            if (x < table_->x[layer + 1]) {
+                return offset + x;
+            }
+            if (layer == 0) {
+                // The tail is the distribution itself shifted by kTail.
+                offset += kTail;
+                continue;
+            }
+            const double y =
+                table_->y[layer] + dist_detail::OpenAbove(dist_detail::Bits64(gen)) *
+                                      (table_->y[layer + 1] - table_->y[layer]);
+            if (y < std::exp(-x)) {
+                return offset + x;
+            }
+        }
+    }
+
+    RealType inverse_lambda_;
+    const dist_detail::Ziggurat<256>* table_;
+};
+
+// Zipf distribution on 1..n with P(k) ~ k^-exponent, by rejection-inversion (Hörmann and
+// Derflinger, "Rejection-inversion to generate variates from monotone discrete
+// distributions"): O(1) expected time and memory for any n, fewer than 1.1 draws on average.
+template <class IntType = int64_t>
+class ZipfDistribution {
+   public:
+    static_assert(std::is_integral_v<IntType>, "template argument must be an integral type");
+
+    ZipfDistribution(IntType n, double exponent)
+        : n_{n}
+        , exponent_{exponent}
+        , h_integral_x1_{HIntegral(1.5) - 1}
+        , h_integral_n_{HIntegral(static_cast<double>(n) + 0.5)}
+        , s_{2 - HIntegralInverse(HIntegral(2.5) - H(2))} {
+        if (n < 1 || !(exponent > 0)) {
+            throw std::invalid_argument{"Zipf needs n >= 1 and exponent > 0"};
+        }
+    }
+
+    template <class Gen>
+    IntType operator()(Gen& gen) const {
+        while (true) {
+            const double u =
+                h_integral_n_ + dist_detail::OpenAbove(dist_detail::Bits64(gen)) *
+                                    (h_integral_x1_ - h_integral_n_);
+            const double x = HIntegralInverse(u);
+            auto k = static_cast<IntType>(x + 0.5);
+            k = std::clamp<IntType>(k, 1, n_);
+            const auto real_k = static_cast<double>(k);
+            if (real_k - x <= s_ || u >= HIntegral(real_k + 0.5) - H(real_k)) {
+                return k;
+            }
+        }
+    }
+
+   private:
+    // H is an antiderivative of the hat function h(x) = x^-exponent.
+    [[nodiscard]] double HIntegral(double x) const {
+        const double log_x = std::log(x);
+        return Helper2((1 - exponent_) * log_x) * log_x;
+    }
+
+    [[nodiscard]] double H(double x) const {
+        return std::exp(-exponent_ * std::log(x));
+    }
+
+    [[nodiscard]] double HIntegralInverse(double x) const {
+        const double t = std::max(x * (1 - exponent_), -1.0);
+        return std::exp(Helper1(t) * x);
+    }
+
+    // log1p(x) / x and expm1(x) / x, continuous at 0 (exponent == 1).
+    static double Helper1(double x) {
+        if (std::abs(x) > 1e-8) {
+            return std::log1p(x) / x;
+        }
+        return 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+    }
+
+    static double Helper2(double x) {
+        if (std::abs(x) > 1e-8) {
+            return std::expm1(x) / x;
+        }
+        return 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x));
+    }
+
+    IntType n_;
+    double exponent_;
+    double h_integral_x1_;
+    double h_integral_n_;
+    double s_;
+};
+
+// Discrete distribution over 0..weights.size()-1 proportional to the weights, by Walker's
+// alias method with Vose's O(n) construction: a sample is one bounded index and one
+// uniform compare.
+template <class IntType = int>
+class DiscreteDistribution {
+   public:
+    static_assert(std::is_integral_v<IntType>, "template argument must be an integral type");
+
+    explicit DiscreteDistribution(std::span<const double> weights)
+        : probability_(weights.size()), alias_(weights.size()) {
+        const size_t n = weights.size();
+        if (n == 0) {
+            throw std::invalid_argument{"DiscreteDistribution needs at least one weight"};
+        }
+        // Indices and aliases are stored as IntType.
+        if (constexpr auto kMaxIndex = static_cast<uint64_t>(std::numeric_limits<IntType>::max());
+            n - 1 > kMaxIndex) {
+            throw std::invalid_argument{"too many weights for the index type"};
+        }
+        double total = 0;
+        for (const double weight : weights) {
+            if (!(weight >= 0)) {
+                throw std::invalid_argument{"weights must be non-negative"};
+            }
+            total += weight;
+        }
+        if (!(total > 0)) {
+            throw std::invalid_argument{"weights must not all be zero"};
+        }
+        std::vector<double> scaled(n);
+        std::vector<IntType> small;
+        std::vector<IntType> large;
+        for (size_t i = 0; i < n; ++i) {
+            scaled[i] = weights[i] * static_cast<double>(n) / total;
+            (scaled[i] < 1 ? small : large).push_back(static_cast<IntType>(i));
+        }
+        while (!small.empty() && !large.empty()) {
+            const IntType less = small.back();
+            small.pop_back();
+            const IntType more = large.back();
+            probability_[less] = scaled[less];
+            alias_[less] = more;
+            scaled[more] += scaled[less] - 1;
+            if (scaled[more] < 1) {
+                large.pop_back();
+                small.push_back(more);
+            }
+        }
+        // Whatever is left is 1 up to rounding.
+        for (const IntType i : large) {
+            probability_[i] = 1;
+            alias_[i] = i;
+        }
+        for (const IntType i : small) {
+            probability_[i] = 1;
+            alias_[i] = i;
+        }
+    }
+
+    template <class Gen>
+    IntType operator()(Gen& gen) const {
+        UniformIntDistribution<size_t> column{0, probability_.size() - 1};
+        const size_t i = column(gen);
+        const double u = dist_detail::OpenAbove(dist_detail::Bits64(gen));
+        return u < probability_[i] ? static_cast<IntType>(i) : alias_[i];
+    }
+
+   private:
+    std::vector<double> probability_;
+    std::vector<IntType> alias_;
+};
@@ -0,0 +1,198 @@
+#include "dist.h"
+#include "perf_benchmark.h"
+#include "philox.h"
+#include "util.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+constexpr int kFrom = 0;
+constexpr int kTo = 999;
+constexpr size_t kBatch = 4096;
+
+template <class Gen>
+void BM_StdUniformInt(benchmark::State& state) {
+    Gen gen{1};
+    std::uniform_int_distribution<int> dist{kFrom, kTo};
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dist(gen));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <class Gen>
+void BM_UniformInt(benchmark::State& state) {
+    Gen gen{1};
+    UniformIntDistribution<int> dist{kFrom, kTo};
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dist(gen));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <class Gen>
+void BM_FixedUniformInt(benchmark::State& state) {
+    Gen gen{1};
+    const FixedUniformIntDistribution<kFrom, kTo> dist;
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dist(gen));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <class Gen>
+void BM_StdUniformIntLoop(benchmark::State& state) {
+    Gen gen{1};
+    std::uniform_int_distribution<int> dist{kFrom, kTo};
+    std::vector<int> out(kBatch);
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        for (auto& value : out) {
+            value = dist(gen);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kBatch));
+}
+
+template <class Gen>
+void BM_UniformIntFill(benchmark::State& state) {
+    Gen gen{1};
+    UniformIntDistribution<int> dist{kFrom, kTo};
+    std::vector<int> out(kBatch);
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        dist.Fill(out, gen);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kBatch));
+}
+
+template <class Gen>
+void BM_FixedUniformIntFill(benchmark::State& state) {
+    Gen gen{1};
+    const FixedUniformIntDistribution<kFrom, kTo> dist;
+    std::vector<int> out(kBatch);
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        dist.Fill(out, gen);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kBatch));
+}
+
+template <class Gen>
+void BM_StdUniformReal(benchmark::State& state) {
+    Gen gen{1};
+    std::uniform_real_distribution<double> dist{-1, 1};
+    std::vector<double> out(kBatch);
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        for (auto& value : out) {
+            value = dist(gen);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kBatch));
+}
+
+template <class Gen, class Dist>
+void BM_UniformRealFill(benchmark::State& state) {
+    Gen gen{1};
+    Dist dist{-1, 1};
+    std::vector<double> out(kBatch);
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        dist.Fill(out, gen);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kBatch));
+}
+
+template <class Dist>
+void BM_Distribution(benchmark::State& state, Dist dist) {
+    std::mt19937_64 gen{1};
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dist(gen));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_StdPermutation(benchmark::State& state) {
+    std::mt19937 gen{1};
+    std::vector<int> permutation(static_cast<size_t>(state.range(0)));
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::ranges::shuffle(permutation, gen);
+        benchmark::DoNotOptimize(permutation.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Size x threads.
+void BM_GenPermutation(benchmark::State& state) {
+    ParallelRandomGenerator gen{1, static_cast<unsigned>(state.range(1))};
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(gen.GenPermutation(static_cast<size_t>(state.range(0))).data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void PermutationArgs(benchmark::internal::Benchmark* b) {
+    const auto threads = static_cast<int64_t>(std::max(std::thread::hardware_concurrency(), 1U));
+    for (const int64_t size : {1 << 20, 1 << 24, 1 << 27}) {
+        b->Args({size, 1});
+        if (threads > 1) {
+            b->Args({size, threads});
+        }
+    }
+}
+
+BENCHMARK(BM_StdUniformInt<std::mt19937>);
+BENCHMARK(BM_UniformInt<std::mt19937>);
+BENCHMARK(BM_FixedUniformInt<std::mt19937>);
+BENCHMARK(BM_StdUniformInt<std::mt19937_64>);
+BENCHMARK(BM_UniformInt<std::mt19937_64>);
+BENCHMARK(BM_FixedUniformInt<std::mt19937_64>);
+BENCHMARK(BM_StdUniformIntLoop<std::mt19937>);
+BENCHMARK(BM_UniformIntFill<std::mt19937>);
+BENCHMARK(BM_FixedUniformIntFill<std::mt19937>);
+BENCHMARK(BM_StdUniformIntLoop<Philox4x32>);
+BENCHMARK(BM_UniformIntFill<Philox4x32>);
+BENCHMARK(BM_FixedUniformIntFill<Philox4x32>);
+BENCHMARK(BM_StdUniformReal<std::mt19937>);
+BENCHMARK(BM_UniformRealFill<std::mt19937, UniformRealDistribution<>>);
+BENCHMARK(BM_UniformRealFill<std::mt19937, FastUniformRealDistribution<>>);
+BENCHMARK(BM_StdUniformReal<std::mt19937_64>);
+BENCHMARK(BM_UniformRealFill<std::mt19937_64, UniformRealDistribution<>>);
+BENCHMARK(BM_UniformRealFill<std::mt19937_64, FastUniformRealDistribution<>>);
+BENCHMARK_CAPTURE(BM_Distribution, StdNormal, std::normal_distribution<double>{});
+BENCHMARK_CAPTURE(BM_Distribution, Normal, NormalDistribution<>{});
+BENCHMARK_CAPTURE(BM_Distribution, StdExponential, std::exponential_distribution<double>{});
+BENCHMARK_CAPTURE(BM_Distribution, Exponential, ExponentialDistribution<>{});
+BENCHMARK_CAPTURE(BM_Distribution, Zipf, ZipfDistribution<>{1'000'000, 1.1});
+BENCHMARK_CAPTURE(
+    BM_Distribution, Discrete,
+    DiscreteDistribution<>{std::vector<double>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}});
+BENCHMARK(BM_StdPermutation)
+    ->Arg(1 << 20)
+    ->Arg(1 << 24)
+    ->Arg(1 << 27)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GenPermutation)->Apply(PermutationArgs)->Unit(benchmark::kMillisecond);
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,289 @@
+#include "dist.h"
+#include "philox.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+// Pearson's chi-squared statistic of counts against equal expected frequencies.
+double ChiSquared(const std::vector<int64_t>& counts, int64_t draws) {
+    const double expected = static_cast<double>(draws) / static_cast<double>(counts.size());
+    double chi_squared = 0;
+    for (const int64_t count : counts) {
+        const double diff = static_cast<double>(count) - expected;
+        chi_squared += diff * diff / expected;
+    }
+    return chi_squared;
+}
+
+// Fill and FixedUniformIntDistribution must give the values of repeated operator() calls
+// and leave the engine in the same state.
+template <class Engine, auto From, auto To>
+void ExpectSameAsOperator() {
+    using T = decltype(From);
+    constexpr size_t kDraws = 2000;
+    Engine gen{42};
+    Engine fixed_gen{42};
+    Engine fill_gen{42};
+    UniformIntDistribution<T> dist{From, To};
+    const FixedUniformIntDistribution<From, To> fixed;
+    std::vector<T> filled(kDraws);
+    UniformIntDistribution<T>{From, To}.Fill(std::span{filled}, fill_gen);
+    for (size_t i = 0; i < kDraws; ++i) {
+        const T expected = dist(gen);
+        ASSERT_EQ(fixed(fixed_gen), expected) << From << ".." << To << " draw " << i;
+        ASSERT_EQ(filled[i], expected) << From << ".." << To << " draw " << i;
+    }
+    const auto next = gen();
+    EXPECT_EQ(fixed_gen(), next);
+    EXPECT_EQ(fill_gen(), next);
+}
+
+template <class Engine>
+class UniformIntTest : public testing::Test {};
+
+// Full 32-bit, full 64-bit and Philox engines take the Lemire paths; minstd_rand, whose
+// range starts at 1, takes the generic one.
+using Engines = testing::Types<std::mt19937, std::mt19937_64, Philox4x32, std::minstd_rand>;
+TYPED_TEST_SUITE(UniformIntTest, Engines);
+
+TYPED_TEST(UniformIntTest, SameAsOperator) {
+    ExpectSameAsOperator<TypeParam, 0, 9>();
+    ExpectSameAsOperator<TypeParam, -1000, 1000>();
+    ExpectSameAsOperator<TypeParam, uint32_t{0}, uint32_t{0x80000000}>();
+    ExpectSameAsOperator<TypeParam, int64_t{-5}, int64_t{1'000'000'000'000}>();
+    ExpectSameAsOperator<TypeParam, uint64_t{1}, std::numeric_limits<uint64_t>::max() / 3>();
+}
+
+TYPED_TEST(UniformIntTest, Extremes) {
+    // Full ranges, which have no range + 1 to reduce by.
+    ExpectSameAsOperator<TypeParam, uint64_t{0}, std::numeric_limits<uint64_t>::max()>();
+    ExpectSameAsOperator<
+        TypeParam, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()>();
+    ExpectSameAsOperator<
+        TypeParam, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()>();
+    ExpectSameAsOperator<TypeParam, uint32_t{0}, std::numeric_limits<uint32_t>::max()>();
+    // Ranges of a single value.
+    ExpectSameAsOperator<TypeParam, 7, 7>();
+    ExpectSameAsOperator<
+        TypeParam, std::numeric_limits<int>::min(), std::numeric_limits<int>::min()>();
+    ExpectSameAsOperator<
+        TypeParam, std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max()>();
+
+    TypeParam gen{1};
+    const FixedUniformIntDistribution<7, 7> single;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(single(gen), 7);
+    }
+    // The full 64-bit range reaches both halves.
+    UniformIntDistribution<uint64_t> full{0, std::numeric_limits<uint64_t>::max()};
+    bool high = false;
+    bool low = false;
+    for (int i = 0; i < 100; ++i) {
+        (full(gen) >> 63U != 0 ? high : low) = true;
+    }
+    EXPECT_TRUE(high);
+    EXPECT_TRUE(low);
+}
+
+// Every value of a small range is equally likely. With 10^6 draws the statistic stays
+// below the 0.1% critical value unless the draws are biased.
+TYPED_TEST(UniformIntTest, SmallRangesAreUnbiased) {
+    constexpr int64_t kDraws = 1'000'000;
+    // 0.1% critical values of chi-squared with 2, 5 and 9 degrees of freedom.
+    const std::vector<std::pair<int, double>> ranges = {{3, 13.82}, {6, 20.52}, {10, 27.88}};
+    for (const auto& [size, critical] : ranges) {
+        TypeParam gen{2024};
+        std::vector<int64_t> counts(static_cast<size_t>(size));
+        std::vector<int> values(kDraws);
+        UniformIntDistribution<int>{0, size - 1}.Fill(std::span{values}, gen);
+        for (const int value : values) {
+            ASSERT_GE(value, 0);
+            ASSERT_LT(value, size);
+            ++counts[static_cast<size_t>(value)];
+        }
+        EXPECT_LT(ChiSquared(counts, kDraws), critical) << size;
+    }
+}
+
+// 3 * 2^30 values from 32-bit words: multiply-shift without rejection would map two words
+// to every k divisible by 3 and one word to the others, i.e. half of the draws instead of a
+// third.
+TEST(UniformIntBiasTest, RejectionRemovesMultiplyShiftBias) {
+    constexpr uint32_t kRange = 3U << 30U;
+    constexpr int64_t kDraws = 300'000;
+    std::mt19937 gen{5};
+    const FixedUniformIntDistribution<uint32_t{0}, kRange - 1> dist;
+    int64_t divisible = 0;
+    for (int64_t i = 0; i < kDraws; ++i) {
+        divisible += dist(gen) % 3 == 0 ? 1 : 0;
+    }
+    EXPECT_NEAR(static_cast<double>(divisible) / kDraws, 1.0 / 3, 0.01);
+}
+
+// Sample mean and variance of 10^6 draws, within about five standard errors.
+TEST(NormalDistributionTest, MeanAndVariance) {
+    constexpr int kDraws = 1'000'000;
+    for (const auto& [mean, stddev] : {std::pair{0.0, 1.0}, std::pair{3.0, 2.0}}) {
+        std::mt19937_64 gen{11};
+        NormalDistribution dist{mean, stddev};
+        double sum = 0;
+        double sum_squares = 0;
+        int beyond_two = 0;
+        for (int i = 0; i < kDraws; ++i) {
+            const double x = dist(gen);
+            sum += x;
+            sum_squares += x * x;
+            beyond_two += std::abs(x - mean) > 2 * stddev ? 1 : 0;
+        }
+        const double sample_mean = sum / kDraws;
+        const double sample_variance = sum_squares / kDraws - sample_mean * sample_mean;
+        EXPECT_NEAR(sample_mean, mean, 5 * stddev / std::sqrt(kDraws));
+        EXPECT_NEAR(sample_variance, stddev * stddev, 0.01 * stddev * stddev);
+        // P(|Z| > 2) = 0.0455 checks the shape beyond the first two moments.
+        EXPECT_NEAR(static_cast<double>(beyond_two) / kDraws, 0.0455, 0.001);
+    }
+}
+
+// The Ziggurat tail starts at 3.654; draws past it come from the separate tail sampler.
+TEST(NormalDistributionTest, TailFrequency) {
+    constexpr int kDraws = 4'000'000;
+    std::mt19937 gen{12};
+    NormalDistribution dist;
+    int tail = 0;
+    for (int i = 0; i < kDraws; ++i) {
+        tail += std::abs(dist(gen)) > 3.6541528853610088 ? 1 : 0;
+    }
+    // P(|Z| > 3.654) = 2.58e-4, about 1000 draws.
+    EXPECT_NEAR(static_cast<double>(tail) / kDraws, 2.58e-4, 2.5e-5);
+}
+
+TEST(ExponentialDistributionTest, Mean) {
+    constexpr int kDraws = 1'000'000;
+    std::mt19937_64 gen{13};
+    ExponentialDistribution dist{4.0};
+    double sum = 0;
+    for (int i = 0; i < kDraws; ++i) {
+        const double x = dist(gen);
+        ASSERT_GE(x, 0);
+        sum += x;
+    }
+    EXPECT_NEAR(sum / kDraws, 0.25, 5 * 0.25 / std::sqrt(kDraws));
+}
+
+// Draws stay in 1..n and rank 1 comes up with probability 1 / H(n, s), H(n, s) being the
+// sum of k^-s, for exponents below, at and above the s == 1 special case.
+TEST(ZipfDistributionTest, SupportAndRankOneFrequency) {
+    constexpr int kDraws = 200'000;
+    for (const int64_t n : {1, 2, 10, 1000}) {
+        for (const double exponent : {0.5, 1.0, 1.0 + 1e-10, 1.5, 3.0}) {
+            double harmonic = 0;
+            for (int64_t k = 1; k <= n; ++k) {
+                harmonic += std::pow(static_cast<double>(k), -exponent);
+            }
+            const double p = 1 / harmonic;
+            std::mt19937 gen{14};
+            const ZipfDistribution<int64_t> dist{n, exponent};
+            int rank_one = 0;
+            for (int i = 0; i < kDraws; ++i) {
+                const int64_t k = dist(gen);
+                ASSERT_GE(k, 1);
+                ASSERT_LE(k, n);
+                rank_one += k == 1 ? 1 : 0;
+            }
+            const double tolerance = 5 * std::sqrt(p * (1 - p) / kDraws) + 1e-9;
+            EXPECT_NEAR(static_cast<double>(rank_one) / kDraws, p, tolerance)
+                << "n " << n << " exponent " << exponent;
+        }
+    }
+}
+
+TEST(ZipfDistributionTest, RejectsBadParameters) {
+    EXPECT_THROW(ZipfDistribution<int64_t>(0, 1.0), std::invalid_argument);
+    EXPECT_THROW(ZipfDistribution<int64_t>(10, 0.0), std::invalid_argument);
+    EXPECT_THROW(
+        ZipfDistribution<int64_t>(10, std::numeric_limits<double>::quiet_NaN()),
+        std::invalid_argument);
+}
+
+// Frequencies of 10^6 draws against the weights, with a chi-squared test at 0.1%.
+TEST(DiscreteDistributionTest, FrequenciesFollowWeights) {
+    constexpr int kDraws = 1'000'000;
+    const std::vector<double> weights = {1, 2, 3, 4, 0.5, 9.5};
+    constexpr double kCritical = 20.52;  // 5 degrees of freedom.
+    double total = 0;
+    for (const double weight : weights) {
+        total += weight;
+    }
+    std::mt19937 gen{15};
+    const DiscreteDistribution<int> dist{weights};
+    std::vector<int64_t> counts(weights.size());
+    for (int i = 0; i < kDraws; ++i) {
+        const int index = dist(gen);
+        ASSERT_GE(index, 0);
+        ASSERT_LT(index, static_cast<int>(weights.size()));
+        ++counts[static_cast<size_t>(index)];
+    }
+    double chi_squared = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        const double expected = kDraws * weights[i] / total;
+        const double diff = static_cast<double>(counts[i]) - expected;
+        chi_squared += diff * diff / expected;
+    }
+    EXPECT_LT(chi_squared, kCritical);
+}
+
+TEST(DiscreteDistributionTest, ZeroWeightsAreNeverDrawn) {
+    const std::vector<double> weights = {0, 1, 0, 0, 3, 0};
+    std::mt19937_64 gen{16};
+    const DiscreteDistribution<int> dist{weights};
+    int fourth = 0;
+    for (int i = 0; i < 100'000; ++i) {
+        const int index = dist(gen);
+        ASSERT_TRUE(index == 1 || index == 4) << index;
+        fourth += index == 4 ? 1 : 0;
+    }
+    EXPECT_NEAR(fourth / 100'000.0, 0.75, 0.01);
+}
+
+TEST(DiscreteDistributionTest, SingleWeight) {
+    const std::vector<double> weights = {0.25};
+    Philox4x32 gen{17};
+    const DiscreteDistribution<int> dist{weights};
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(dist(gen), 0);
+    }
+}
+
+TEST(DiscreteDistributionTest, RejectsBadWeights) {
+    using Weights = std::vector<double>;
+    EXPECT_THROW(DiscreteDistribution<int>(Weights{}), std::invalid_argument);
+    EXPECT_THROW(DiscreteDistribution<int>(Weights{0, 0}), std::invalid_argument);
+    EXPECT_THROW(DiscreteDistribution<int>(Weights{1, -1}), std::invalid_argument);
+    EXPECT_THROW(
+        DiscreteDistribution<int>(Weights{1, std::numeric_limits<double>::quiet_NaN()}),
+        std::invalid_argument);
+}
+
+// Indices 0..127 fit in int8_t, index 128 does not.
+TEST(DiscreteDistributionTest, RejectsIndicesPastIntType) {
+    const std::vector<double> fits(128, 1.0);
+    const DiscreteDistribution<int8_t> dist{fits};
+    std::mt19937 gen{18};
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_GE(dist(gen), 0);
+    }
+    using Weights = std::vector<double>;
+    EXPECT_THROW(DiscreteDistribution<int8_t>(Weights(129, 1.0)), std::invalid_argument);
+    EXPECT_NO_THROW(DiscreteDistribution<uint8_t>(Weights(256, 1.0)));
+    EXPECT_THROW(DiscreteDistribution<uint8_t>(Weights(257, 1.0)), std::invalid_argument);
+}
+}  // namespace
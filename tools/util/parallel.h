@@ -0,0 +1,22 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Runs fn(begin, end) on up to `threads` contiguous chunks of [0, count) of at least
+// min_chunk elements each; the last chunk runs on the calling thread.
+template <class Fn>
+void ParallelFor(size_t count, unsigned threads, size_t min_chunk, const Fn& fn) {
+    const size_t chunks = std::clamp<size_t>(count / std::max<size_t>(min_chunk, 1), 1, threads);
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (size_t chunk = 0; chunk + 1 < chunks; ++chunk) {
+        workers.emplace_back(fn, count * chunk / chunks, count * (chunk + 1) / chunks);
+    }
+    fn(count * (chunks - 1) / chunks, count);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
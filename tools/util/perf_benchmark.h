@@ -0,0 +1,82 @@
+#pragma once
+
+#include "perf_counters.h"
+
+#include <optional>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+// Adds the counters of PerfCounters to a benchmark's report line when it goes out of scope:
+// IPC, and cycles, cache misses, branch misses and page faults per item (per iteration if
+// the benchmark sets no items processed). Create it right before the benchmark loop, so that
+// the setup before the loop is not counted, and in the same scope as SetItemsProcessed:
+//
+//     const BenchmarkPerfCounters perf{state};
+//     for (auto _ : state) { ... }
+//     state.SetItemsProcessed(...);
+//
+// The counters do not see state.PauseTiming(). Benchmarks with setup inside the loop call
+// PauseTiming() and ResumeTiming() on this class instead, which stop the timer and the
+// counters together:
+//
+//     BenchmarkPerfCounters perf{state};
+//     for (auto _ : state) {
+//         perf.PauseTiming();
+//         ...  // setup, neither timed nor counted
+//         perf.ResumeTiming();
+//         ...
+//     }
+class BenchmarkPerfCounters {
+   public:
+    explicit BenchmarkPerfCounters(benchmark::State& state) : state_{state} {
+    }
+
+    BenchmarkPerfCounters(const BenchmarkPerfCounters&) = delete;
+    BenchmarkPerfCounters& operator=(const BenchmarkPerfCounters&) = delete;
+    BenchmarkPerfCounters(BenchmarkPerfCounters&&) = delete;
+    BenchmarkPerfCounters& operator=(BenchmarkPerfCounters&&) = delete;
+
+    void PauseTiming() {
+        state_.PauseTiming();
+#ifdef __linux__
+        counters_.Pause();
+#endif
+    }
+
+    void ResumeTiming() {
+#ifdef __linux__
+        counters_.Resume();
+#endif
+        state_.ResumeTiming();
+    }
+
+    ~BenchmarkPerfCounters() {
+#ifdef __linux__
+        const PerfValues values = counters_.Read();
+        const int64_t items = state_.items_processed();
+        const double per = static_cast<double>(items > 0 ? items : state_.iterations());
+        if (per == 0) {
+            return;
+        }
+        if (const auto ipc = values.Ipc()) {
+            state_.counters["IPC"] = *ipc;
+        }
+        const auto add = [&](const char* name, std::optional<uint64_t> value) {
+            if (value) {
+                state_.counters[name] = static_cast<double>(*value) / per;
+            }
+        };
+        add("cycles/item", values.cycles);
+        add("cache_misses/item", values.cache_misses);
+        add("branch_misses/item", values.branch_misses);
+        add("page_faults/item", values.page_faults);
+#endif
+    }
+
+   private:
+    benchmark::State& state_;
+#ifdef __linux__
+    PerfCounters counters_;
+#endif
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#ifdef __linux__
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <optional>
+#include <system_error>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Counts between construction of PerfCounters and Read(); a value is empty when its event
+// could not be opened.
+struct PerfValues {
+    std::optional<uint64_t> cycles;
+    std::optional<uint64_t> instructions;
+    std::optional<uint64_t> cache_misses;
+    std::optional<uint64_t> branch_misses;
+    std::optional<uint64_t> page_faults;
+    // CPU time in ns, from the software task clock.
+    std::optional<uint64_t> task_clock;
+
+    [[nodiscard]] std::optional<double> Ipc() const {
+        if (!cycles || !instructions || *cycles == 0) {
+            return std::nullopt;
+        }
+        return static_cast<double>(*instructions) / static_cast<double>(*cycles);
+    }
+};
+
+// Hardware and software counters of the calling thread, and of the threads it starts while
+// counting, through perf_event_open. Only user-space events are counted, which
+// perf_event_paranoid <= 2 allows to unprivileged processes. Containers and VMs often hide the
+// hardware events; the software ones (page faults, task clock) still work there, and when
+// perf_event_open is not permitted at all the page faults come from getrusage.
+class PerfCounters {
+   public:
+    PerfCounters() {
+        for (size_t i = 0; i < kEvents.size(); ++i) {
+            fds_[i] = Open(kEvents[i]);
+        }
+        if (fds_[kPageFaults] < 0) {
+            rusage_start_ = ThreadPageFaults();
+        }
+        Control(PERF_EVENT_IOC_RESET);
+        Control(PERF_EVENT_IOC_ENABLE);
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    PerfCounters(PerfCounters&&) = delete;
+    PerfCounters& operator=(PerfCounters&&) = delete;
+
+    ~PerfCounters() {
+        for (const int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    // Stops counting until Resume(), e.g. around per-iteration setup.
+    void Pause() {
+        Control(PERF_EVENT_IOC_DISABLE);
+        if (rusage_start_) {
+            rusage_paused_ = ThreadPageFaults();
+        }
+    }
+
+    void Resume() {
+        if (rusage_start_ && rusage_paused_) {
+            *rusage_start_ += ThreadPageFaults() - *rusage_paused_;
+            rusage_paused_.reset();
+        }
+        Control(PERF_EVENT_IOC_ENABLE);
+    }
+
+    // Whether cycles and instructions are counted.
+    [[nodiscard]] bool Hardware() const {
+        return fds_[kCycles] >= 0 && fds_[kInstructions] >= 0;
+    }
+
+    [[nodiscard]] PerfValues Read() const {
+        PerfValues values{
+            .cycles = Value(kCycles),
+            .instructions = Value(kInstructions),
+            .cache_misses = Value(kCacheMisses),
+            .branch_misses = Value(kBranchMisses),
+            .page_faults = Value(kPageFaults),
+            .task_clock = Value(kTaskClock)};
+        if (rusage_start_) {
+            values.page_faults = rusage_paused_.value_or(ThreadPageFaults()) - *rusage_start_;
+        }
+        return values;
+    }
+
+   private:
+    enum Event : size_t {
+        kCycles,
+        kInstructions,
+        kCacheMisses,
+        kBranchMisses,
+        kPageFaults,
+        kTaskClock,
+    };
+
+    struct EventType {
+        uint32_t type;
+        uint64_t config;
+    };
+
+    static constexpr std::array<EventType, 6> kEvents{{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    }};
+
+    // Events are opened separately rather than as a group, so that the ones the machine
+    // lacks do not take the others down; the kernel may then multiplex them, which Value
+    // corrects for.
+    static int Open(EventType event) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    // Applies an ioctl to every open event, and to its copies in the threads started since.
+    void Control(unsigned long request) {  // NOLINT(google-runtime-int)
+        for (const int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, request, 0);
+            }
+        }
+    }
+
+    [[nodiscard]] std::optional<uint64_t> Value(Event event) const {
+        const int fd = fds_[event];
+        // value, time enabled, time running.
+        std::array<uint64_t, 3> data{};
+        if (fd < 0 || read(fd, data.data(), sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+            return std::nullopt;
+        }
+        const auto [value, enabled, running] = data;
+        if (running == 0) {
+            return value == 0 && enabled == 0 ? std::optional<uint64_t>{0} : std::nullopt;
+        }
+        if (running < enabled) {
+            return static_cast<uint64_t>(
+                static_cast<double>(value) * static_cast<double>(enabled) /
+                static_cast<double>(running));
+        }
+        return value;
+    }
+
+    static uint64_t ThreadPageFaults() {
+        rusage usage{};
+        if (getrusage(RUSAGE_THREAD, &usage) != 0) {
+            throw std::system_error{errno, std::generic_category()};
+        }
+        return static_cast<uint64_t>(usage.ru_minflt + usage.ru_majflt);
+    }
+
+    std::array<int, kEvents.size()> fds_{};
+    std::optional<uint64_t> rusage_start_;
+    std::optional<uint64_t> rusage_paused_;
+};
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as
+// 1, 2, 3"). Every block of four outputs is a pure function of the key and a 128-bit
+// counter, so any position can be reached in O(1): the low 64 bits of the counter index
+// blocks within a stream, the high 64 bits select the stream.
+class Philox4x32 {
+   public:
+    using result_type = uint32_t;  // NOLINT
+
+    explicit Philox4x32(
+        uint64_t seed = 0,     // NOLINT(fuchsia-default-arguments-declarations)
+        uint64_t stream = 0)  // NOLINT(fuchsia-default-arguments-declarations)
+        : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32U)}
+        , stream_{stream} {
+    }
+
+    static constexpr result_type min() {  // NOLINT
+        return 0;
+    }
+
+    static constexpr result_type max() {  // NOLINT
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        if (index_ == kWords) {
+            output_ = Block(key_, block_++, stream_);
+            index_ = 0;
+        }
+        return output_[index_++];
+    }
+
+    // Skips count outputs of the current stream.
+    void Discard(uint64_t count) {
+        const uint64_t position = block_ * kWords - (kWords - index_) + count;
+        block_ = position / kWords;
+        index_ = kWords;
+        if (const auto offset = static_cast<uint32_t>(position % kWords); offset != 0) {
+            output_ = Block(key_, block_++, stream_);
+            index_ = offset;
+        }
+    }
+
+    // Generator with the same key positioned at the start of another stream.
+    [[nodiscard]] Philox4x32 Split(uint64_t stream) const {
+        Philox4x32 result{*this};
+        result.stream_ = stream;
+        result.block_ = 0;
+        result.index_ = kWords;
+        return result;
+    }
+
+    [[nodiscard]] std::array<uint32_t, 2> Key() const {
+        return key_;
+    }
+
+    static constexpr std::array<uint32_t, 4> Block(
+        std::array<uint32_t, 2> key, uint64_t block, uint64_t stream) {
+        std::array<uint32_t, 4> counter{
+            static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32U),
+            static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32U)};
+        for (int round = 0; round < kRounds; ++round) {
+            const uint64_t product0 = uint64_t{kMultiplier0} * counter[0];
+            const uint64_t product1 = uint64_t{kMultiplier1} * counter[2];
+            counter = {
+                static_cast<uint32_t>(product1 >> 32U) ^ counter[1] ^ key[0],
+                static_cast<uint32_t>(product1),
+                static_cast<uint32_t>(product0 >> 32U) ^ counter[3] ^ key[1],
+                static_cast<uint32_t>(product0)};
+            key[0] += kWeyl0;
+            key[1] += kWeyl1;
+        }
+        return counter;
+    }
+
+   private:
+    static constexpr uint32_t kWords = 4;
+    static constexpr int kRounds = 10;
+    static constexpr uint32_t kMultiplier0 = 0xD2511F53;
+    static constexpr uint32_t kMultiplier1 = 0xCD9E8D57;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+    std::array<uint32_t, 2> key_;
+    uint64_t stream_;
+    uint64_t block_ = 0;
+    std::array<uint32_t, 4> output_{};
+    uint32_t index_ = kWords;
+};
@@ -0,0 +1,396 @@
+#pragma once
+
+#include "dist.h"
+#include "philox.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define UTIL_PHILOX_X86 1
+#endif
+
+// Bulk kernels for BasicRandomGenerator<Philox4x32>. Element i of a fill is drawn from
+// stream first + i, exactly as `dist(engine.Split(first + i))` would draw it; the kernels
+// only compute the first block of sixteen streams at once and map it to values with
+// AVX-512 or AVX2. Lanes that need more than the first block (rejections) are redone by the
+// scalar code, so the output is bit-identical to it on every path.
+//
+// The vector kernels are compiled with target attributes, so no -mavx2 or -march copt is
+// needed: the best path the CPU supports is picked at run time (BestSimd), and callers may
+// force any supported one, as the tests do. Other compilers and architectures get the
+// scalar path.
+
+// First output block of sixteen consecutive streams, as words[word][lane].
+struct PhiloxBatch {
+    static constexpr size_t kSize = 16;
+
+    alignas(64) std::array<std::array<uint32_t, kSize>, 4> words;
+};
+
+// Instruction sets of the bulk kernels, from the slowest.
+enum class Simd { kScalar, kAvx2, kAvx512 };
+
+namespace philox_bulk {
+inline constexpr uint32_t kMultiplier0 = 0xD2511F53;
+inline constexpr uint32_t kMultiplier1 = 0xCD9E8D57;
+inline constexpr uint32_t kWeyl0 = 0x9E3779B9;
+inline constexpr uint32_t kWeyl1 = 0xBB67AE85;
+inline constexpr int kRounds = 10;
+// Largest double below 1, which GenerateCanonical returns instead of 1.
+inline constexpr double kBelowOne = 1.0 - std::numeric_limits<double>::epsilon() / 2;
+inline constexpr double kTwo32 = 4294967296.0;
+inline constexpr double kTwoMinus64 = 1.0 / (kTwo32 * kTwo32);
+
+inline Simd DetectSimd() {
+#if UTIL_PHILOX_X86
+    if (__builtin_cpu_supports("avx512f")) {
+        return Simd::kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Simd::kAvx2;
+    }
+#endif
+    return Simd::kScalar;
+}
+
+inline void FirstBlocksScalar(
+    std::array<uint32_t, 2> key, uint64_t first_stream, PhiloxBatch& batch) {
+    for (size_t lane = 0; lane < PhiloxBatch::kSize; ++lane) {
+        const auto block = Philox4x32::Block(key, 0, first_stream + lane);
+        for (size_t word = 0; word < 4; ++word) {
+            batch.words[word][lane] = block[word];
+        }
+    }
+}
+
+inline uint32_t MulHiScalar(const uint32_t* words, uint32_t range, uint32_t* hi) {
+    uint32_t check = 0;
+    for (size_t lane = 0; lane < PhiloxBatch::kSize; ++lane) {
+        const uint64_t product = uint64_t{words[lane]} * range;
+        hi[lane] = static_cast<uint32_t>(product >> 32U);
+        check |= static_cast<uint32_t>(static_cast<uint32_t>(product) < range) << lane;
+    }
+    return check;
+}
+
+inline void CanonicalScalar(
+    const uint32_t* w0, const uint32_t* w1, double from, double to, double* out) {
+    const double scale = to - from;
+    for (size_t lane = 0; lane < PhiloxBatch::kSize; ++lane) {
+        const double sum = static_cast<double>(w0[lane]) + static_cast<double>(w1[lane]) * kTwo32;
+        const double canonical = std::min(sum * kTwoMinus64, kBelowOne);
+        out[lane] = canonical * scale + from;
+    }
+}
+
+#if UTIL_PHILOX_X86
+// The vector kernels take the counters of the sixteen streams in batch.words[2..3].
+inline void SetCounters(uint64_t first_stream, PhiloxBatch& batch) {
+    for (size_t lane = 0; lane < PhiloxBatch::kSize; ++lane) {
+        const uint64_t stream = first_stream + lane;
+        batch.words[2][lane] = static_cast<uint32_t>(stream);
+        batch.words[3][lane] = static_cast<uint32_t>(stream >> 32U);
+    }
+}
+
+// 32x32->64 products of all lanes, split into their high and low halves.
+__attribute__((target("avx512f"))) inline void MulHiLo(
+    __m512i a, __m512i b, __m512i& hi, __m512i& lo) {
+    const __m512i even = _mm512_mul_epu32(a, b);
+    const __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), b);
+    constexpr __mmask16 kOddLanes = 0xAAAA;
+    lo = _mm512_mask_blend_epi32(kOddLanes, even, _mm512_slli_epi64(odd, 32));
+    hi = _mm512_mask_blend_epi32(kOddLanes, _mm512_srli_epi64(even, 32), odd);
+}
+
+__attribute__((target("avx512f"))) inline void FirstBlocksAvx512(
+    std::array<uint32_t, 2> key, uint64_t first_stream, PhiloxBatch& batch) {
+    auto& words = batch.words;
+    SetCounters(first_stream, batch);
+    __m512i c0 = _mm512_setzero_si512();
+    __m512i c1 = _mm512_setzero_si512();
+    __m512i c2 = _mm512_load_si512(words[2].data());
+    __m512i c3 = _mm512_load_si512(words[3].data());
+    const __m512i m0 = _mm512_set1_epi32(static_cast<int>(kMultiplier0));
+    const __m512i m1 = _mm512_set1_epi32(static_cast<int>(kMultiplier1));
+    for (int round = 0; round < kRounds; ++round) {
+        __m512i hi0;
+        __m512i lo0;
+        __m512i hi1;
+        __m512i lo1;
+        MulHiLo(c0, m0, hi0, lo0);
+        MulHiLo(c2, m1, hi1, lo1);
+        const __m512i k0 = _mm512_set1_epi32(static_cast<int>(key[0]));
+        const __m512i k1 = _mm512_set1_epi32(static_cast<int>(key[1]));
+        c0 = _mm512_xor_si512(_mm512_xor_si512(hi1, c1), k0);
+        c1 = lo1;
+        c2 = _mm512_xor_si512(_mm512_xor_si512(hi0, c3), k1);
+        c3 = lo0;
+        key[0] += kWeyl0;
+        key[1] += kWeyl1;
+    }
+    _mm512_store_si512(words[0].data(), c0);
+    _mm512_store_si512(words[1].data(), c1);
+    _mm512_store_si512(words[2].data(), c2);
+    _mm512_store_si512(words[3].data(), c3);
+}
+
+__attribute__((target("avx512f"))) inline uint32_t MulHiAvx512(
+    const uint32_t* words, uint32_t range, uint32_t* hi) {
+    const __m512i w = _mm512_load_si512(words);
+    __m512i high;
+    __m512i low;
+    MulHiLo(w, _mm512_set1_epi32(static_cast<int>(range)), high, low);
+    _mm512_storeu_si512(hi, high);
+    return _mm512_cmplt_epu32_mask(low, _mm512_set1_epi32(static_cast<int>(range)));
+}
+
+__attribute__((target("avx512f"))) inline void CanonicalAvx512(
+    const uint32_t* w0, const uint32_t* w1, double from, double to, double* out) {
+    const double scale = to - from;
+    for (size_t half = 0; half < PhiloxBatch::kSize; half += 8) {
+        const __m512d low = _mm512_cvtepu32_pd(
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(w0 + half)));
+        const __m512d high = _mm512_cvtepu32_pd(
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(w1 + half)));
+        const __m512d sum = _mm512_add_pd(low, _mm512_mul_pd(high, _mm512_set1_pd(kTwo32)));
+        const __m512d canonical = _mm512_min_pd(
+            _mm512_mul_pd(sum, _mm512_set1_pd(kTwoMinus64)), _mm512_set1_pd(kBelowOne));
+        _mm512_storeu_pd(
+            out + half,
+            _mm512_add_pd(
+                _mm512_mul_pd(canonical, _mm512_set1_pd(scale)), _mm512_set1_pd(from)));
+    }
+}
+
+__attribute__((target("avx2"))) inline void MulHiLo(
+    __m256i a, __m256i b, __m256i& hi, __m256i& lo) {
+    const __m256i even = _mm256_mul_epu32(a, b);
+    const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+    constexpr int kOddLanes = 0xAA;
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), kOddLanes);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, kOddLanes);
+}
+
+// Unsigned a < b per lane, as an all-ones mask.
+__attribute__((target("avx2"))) inline __m256i LessU32(__m256i a, __m256i b) {
+    return _mm256_xor_si256(
+        _mm256_cmpeq_epi32(_mm256_max_epu32(a, b), a), _mm256_set1_epi32(-1));
+}
+
+__attribute__((target("avx2"))) inline __m256d ToDouble(__m128i words) {
+    const __m128i sign = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+    return _mm256_add_pd(
+        _mm256_cvtepi32_pd(_mm_xor_si128(words, sign)), _mm256_set1_pd(2147483648.0));
+}
+
+__attribute__((target("avx2"))) inline void FirstBlocksAvx2(
+    std::array<uint32_t, 2> key, uint64_t first_stream, PhiloxBatch& batch) {
+    auto& words = batch.words;
+    SetCounters(first_stream, batch);
+    const auto start_key = key;
+    for (size_t half = 0; half < PhiloxBatch::kSize; half += 8) {
+        key = start_key;
+        auto* w0 = reinterpret_cast<__m256i*>(words[0].data() + half);  // NOLINT
+        auto* w1 = reinterpret_cast<__m256i*>(words[1].data() + half);  // NOLINT
+        auto* w2 = reinterpret_cast<__m256i*>(words[2].data() + half);  // NOLINT
+        auto* w3 = reinterpret_cast<__m256i*>(words[3].data() + half);  // NOLINT
+        __m256i c0 = _mm256_setzero_si256();
+        __m256i c1 = _mm256_setzero_si256();
+        __m256i c2 = _mm256_load_si256(w2);
+        __m256i c3 = _mm256_load_si256(w3);
+        const __m256i m0 = _mm256_set1_epi32(static_cast<int>(kMultiplier0));
+        const __m256i m1 = _mm256_set1_epi32(static_cast<int>(kMultiplier1));
+        for (int round = 0; round < kRounds; ++round) {
+            __m256i hi0;
+            __m256i lo0;
+            __m256i hi1;
+            __m256i lo1;
+            MulHiLo(c0, m0, hi0, lo0);
+            MulHiLo(c2, m1, hi1, lo1);
+            const __m256i k0 = _mm256_set1_epi32(static_cast<int>(key[0]));
+            const __m256i k1 = _mm256_set1_epi32(static_cast<int>(key[1]));
+            c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), k0);
+            c1 = lo1;
+            c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), k1);
+            c3 = lo0;
+            key[0] += kWeyl0;
+            key[1] += kWeyl1;
+        }
+        _mm256_store_si256(w0, c0);
+        _mm256_store_si256(w1, c1);
+        _mm256_store_si256(w2, c2);
+        _mm256_store_si256(w3, c3);
+    }
+}
+
+__attribute__((target("avx2"))) inline uint32_t MulHiAvx2(
+    const uint32_t* words, uint32_t range, uint32_t* hi) {
+    uint32_t check = 0;
+    for (size_t half = 0; half < PhiloxBatch::kSize; half += 8) {
+        const __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i*>(words + half));
+        const __m256i r = _mm256_set1_epi32(static_cast<int>(range));
+        __m256i high;
+        __m256i low;
+        MulHiLo(w, r, high, low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(hi + half), high);  // NOLINT
+        const auto mask = static_cast<uint32_t>(
+            _mm256_movemask_ps(_mm256_castsi256_ps(LessU32(low, r))));
+        check |= mask << half;
+    }
+    return check;
+}
+
+__attribute__((target("avx2"))) inline void CanonicalAvx2(
+    const uint32_t* w0, const uint32_t* w1, double from, double to, double* out) {
+    const double scale = to - from;
+    for (size_t quarter = 0; quarter < PhiloxBatch::kSize; quarter += 4) {
+        const __m256d low =
+            ToDouble(_mm_load_si128(reinterpret_cast<const __m128i*>(w0 + quarter)));
+        const __m256d high =
+            ToDouble(_mm_load_si128(reinterpret_cast<const __m128i*>(w1 + quarter)));
+        const __m256d sum = _mm256_add_pd(low, _mm256_mul_pd(high, _mm256_set1_pd(kTwo32)));
+        const __m256d canonical = _mm256_min_pd(
+            _mm256_mul_pd(sum, _mm256_set1_pd(kTwoMinus64)), _mm256_set1_pd(kBelowOne));
+        _mm256_storeu_pd(
+            out + quarter,
+            _mm256_add_pd(
+                _mm256_mul_pd(canonical, _mm256_set1_pd(scale)), _mm256_set1_pd(from)));
+    }
+}
+#endif
+}  // namespace philox_bulk
+
+// Fastest kernels of the running CPU, detected once.
+inline Simd BestSimd() {
+    static const Simd simd = philox_bulk::DetectSimd();
+    return simd;
+}
+
+// Whether this CPU and build can run the kernels of simd.
+inline bool SimdSupported(Simd simd) {
+    return simd <= BestSimd();
+}
+
+// The kernels below take the path to use, which must be supported (see SimdSupported).
+
+inline void PhiloxFirstBlocks(
+    std::array<uint32_t, 2> key, uint64_t first_stream, PhiloxBatch& batch,
+    Simd simd = BestSimd()) {  // NOLINT(fuchsia-default-arguments-declarations)
+    using namespace philox_bulk;  // NOLINT(google-build-using-namespace)
+    switch (simd) {
+#if UTIL_PHILOX_X86
+        case Simd::kAvx512:
+            FirstBlocksAvx512(key, first_stream, batch);
+            return;
+        case Simd::kAvx2:
+            FirstBlocksAvx2(key, first_stream, batch);
+            return;
+#endif
+        default:
+            FirstBlocksScalar(key, first_stream, batch);
+            return;
+    }
+}
+
+// High halves of words[lane] * range. Bit `lane` of the result is set when the low half is
+// below range, i.e. when SNd would have to look at its rejection threshold.
+inline uint32_t MulHiBatch(
+    const uint32_t* words, uint32_t range, uint32_t* hi,
+    Simd simd = BestSimd()) {  // NOLINT(fuchsia-default-arguments-declarations)
+    using namespace philox_bulk;  // NOLINT(google-build-using-namespace)
+    switch (simd) {
+#if UTIL_PHILOX_X86
+        case Simd::kAvx512:
+            return MulHiAvx512(words, range, hi);
+        case Simd::kAvx2:
+            return MulHiAvx2(words, range, hi);
+#endif
+        default:
+            return MulHiScalar(words, range, hi);
+    }
+}
+
+// UniformRealDistribution<double> on the first two words: GenerateCanonical combines two
+// 32-bit outputs as (w0 + w1 * 2^32) / 2^64, with the same roundings done here.
+inline void CanonicalBatch(
+    const uint32_t* w0, const uint32_t* w1, double from, double to, double* out,
+    Simd simd = BestSimd()) {  // NOLINT(fuchsia-default-arguments-declarations)
+    using namespace philox_bulk;  // NOLINT(google-build-using-namespace)
+    switch (simd) {
+#if UTIL_PHILOX_X86
+        case Simd::kAvx512:
+            CanonicalAvx512(w0, w1, from, to, out);
+            return;
+        case Simd::kAvx2:
+            CanonicalAvx2(w0, w1, from, to, out);
+            return;
+#endif
+        default:
+            CanonicalScalar(w0, w1, from, to, out);
+            return;
+    }
+}
+
+// Fills out[0, count) with UniformIntDistribution<T>{from, to} drawn from streams first,
+// first + 1, ... of engine. Ranges of 2^32 values or more take the scalar path.
+template <class T, class Out>
+void FillUniformInt(
+    const Philox4x32& engine, uint64_t first, Out* out, size_t count, T from, T to,
+    Simd simd = BestSimd()) {  // NOLINT(fuchsia-default-arguments-declarations)
+    using UCType = std::common_type_t<uint32_t, std::make_unsigned_t<T>>;
+    const UCType urange = static_cast<UCType>(to) - static_cast<UCType>(from);
+    UniformIntDistribution<T> dist{from, to};
+    size_t i = 0;
+    if (urange < std::numeric_limits<uint32_t>::max()) {
+        const auto range = static_cast<uint32_t>(urange + 1);
+        const uint32_t threshold = (0U - range) % range;
+        PhiloxBatch batch;
+        std::array<uint32_t, PhiloxBatch::kSize> hi{};
+        for (; i + PhiloxBatch::kSize <= count; i += PhiloxBatch::kSize) {
+            PhiloxFirstBlocks(engine.Key(), first + i, batch, simd);
+            uint32_t check = MulHiBatch(batch.words[0].data(), range, hi.data(), simd);
+            for (size_t lane = 0; lane < PhiloxBatch::kSize; ++lane) {
+                const UCType value = hi[lane] + static_cast<UCType>(from);
+                out[i + lane] = static_cast<Out>(static_cast<T>(value));
+            }
+            // Only lanes whose low half is below the threshold are rejected and redrawn.
+            while (check != 0) {
+                const auto lane = static_cast<size_t>(std::countr_zero(check));
+                check &= check - 1;
+                if (batch.words[0][lane] * range < threshold) {
+                    Philox4x32 gen = engine.Split(first + i + lane);
+                    out[i + lane] = static_cast<Out>(dist(gen));
+                }
+            }
+        }
+    }
+    for (; i < count; ++i) {
+        Philox4x32 gen = engine.Split(first + i);
+        out[i] = static_cast<Out>(dist(gen));
+    }
+}
+
+// Fills out[0, count) with UniformRealDistribution<double>{from, to}, as FillUniformInt.
+inline void FillUniformReal(
+    const Philox4x32& engine, uint64_t first, double* out, size_t count, double from,
+    double to, Simd simd = BestSimd()) {  // NOLINT(fuchsia-default-arguments-declarations)
+    size_t i = 0;
+    PhiloxBatch batch;
+    for (; i + PhiloxBatch::kSize <= count; i += PhiloxBatch::kSize) {
+        PhiloxFirstBlocks(engine.Key(), first + i, batch, simd);
+        CanonicalBatch(batch.words[0].data(), batch.words[1].data(), from, to, out + i, simd);
+    }
+    UniformRealDistribution dist{from, to};
+    for (; i < count; ++i) {
+        Philox4x32 gen = engine.Split(first + i);
+        out[i] = dist(gen);
+    }
+}
@@ -0,0 +1,139 @@
+#include "philox_bulk.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+// Sizes around the 16-lane batches, and offsets that put streams past 2^32.
+constexpr std::array<size_t, 6> kCounts = {0, 1, 15, 16, 17, 100};
+constexpr std::array<uint64_t, 3> kFirsts = {0, 5, (uint64_t{1} << 32U) - 7};
+
+template <class T, class Out = T>
+void CheckInt(Simd simd, T from, T to) {
+    const Philox4x32 engine{0x0123456789ABCDEF};
+    for (const uint64_t first : kFirsts) {
+        for (const size_t count : kCounts) {
+            std::vector<Out> bulk(count);
+            FillUniformInt(engine, first, bulk.data(), count, from, to, simd);
+            UniformIntDistribution<T> dist{from, to};
+            for (size_t i = 0; i < count; ++i) {
+                Philox4x32 gen = engine.Split(first + i);
+                ASSERT_EQ(bulk[i], static_cast<Out>(dist(gen)))
+                    << "from " << from << " to " << to << " first " << first << " i " << i;
+            }
+        }
+    }
+}
+
+// Random123 known-answer vectors for Philox4x32-10.
+TEST(PhiloxTest, KnownAnswers) {
+    EXPECT_EQ(
+        Philox4x32::Block({0, 0}, 0, 0),
+        (std::array<uint32_t, 4>{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(
+        Philox4x32::Block({0xffffffff, 0xffffffff}, ~uint64_t{0}, ~uint64_t{0}),
+        (std::array<uint32_t, 4>{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(
+        Philox4x32::Block({0xa4093822, 0x299f31d0}, 0x85a308d3243f6a88, 0x0370734413198a2e),
+        (std::array<uint32_t, 4>{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+
+    Philox4x32 engine;
+    EXPECT_EQ(engine(), 0x6627e8d5U);
+    EXPECT_EQ(engine(), 0xe169c58dU);
+}
+
+// Every kernel path the machine can run is checked against the scalar code, so the vector
+// kernels are covered without any -m copt; paths the CPU lacks are skipped.
+class PhiloxBulkTest : public testing::TestWithParam<Simd> {
+   protected:
+    void SetUp() override {
+        if (!SimdSupported(GetParam())) {
+            GTEST_SKIP() << "not supported by this CPU";
+        }
+    }
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    AllPaths, PhiloxBulkTest, testing::Values(Simd::kScalar, Simd::kAvx2, Simd::kAvx512),
+    [](const testing::TestParamInfo<Simd>& info) {
+        switch (info.param) {
+            case Simd::kAvx2:
+                return "Avx2";
+            case Simd::kAvx512:
+                return "Avx512";
+            default:
+                return "Scalar";
+        }
+    });
+
+TEST_P(PhiloxBulkTest, FirstBlocksMatchScalar) {
+    const Philox4x32 engine{0xFEEDFACECAFEBEEF};
+    PhiloxBatch batch;
+    for (const uint64_t first : kFirsts) {
+        PhiloxFirstBlocks(engine.Key(), first, batch, GetParam());
+        for (size_t lane = 0; lane < PhiloxBatch::kSize; ++lane) {
+            const auto block = Philox4x32::Block(engine.Key(), 0, first + lane);
+            for (size_t word = 0; word < 4; ++word) {
+                ASSERT_EQ(batch.words[word][lane], block[word]) << first << " " << lane;
+            }
+        }
+    }
+}
+
+TEST_P(PhiloxBulkTest, UniformInt) {
+    CheckInt<int>(GetParam(), 0, 9);
+    CheckInt<int>(GetParam(), -1000, 1000);
+    CheckInt<uint32_t>(GetParam(), 0, std::numeric_limits<uint32_t>::max() - 1);
+    CheckInt<int64_t>(GetParam(), -5, 1'000'000'007);
+    CheckInt<int, int64_t>(GetParam(), 1, 6);
+}
+
+// Ranges just above 2^31 reject almost half of the first draws, so most batches redo
+// several lanes through the scalar path.
+TEST_P(PhiloxBulkTest, UniformIntRejections) {
+    constexpr uint32_t kRange = 0x80000001;
+    const Philox4x32 engine{0x0123456789ABCDEF};
+    PhiloxBatch batch;
+    PhiloxFirstBlocks(engine.Key(), 0, batch, GetParam());
+    const uint32_t threshold = (0U - kRange) % kRange;
+    size_t rejected = 0;
+    for (size_t lane = 0; lane < PhiloxBatch::kSize; ++lane) {
+        rejected += batch.words[0][lane] * kRange < threshold ? 1 : 0;
+    }
+    EXPECT_GT(rejected, 0U);
+
+    CheckInt<uint32_t>(GetParam(), 0, kRange - 1);
+    CheckInt<int>(GetParam(), std::numeric_limits<int>::min() + 1, 0);
+}
+
+TEST_P(PhiloxBulkTest, UniformIntEdgeRanges) {
+    CheckInt<int>(GetParam(), std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    CheckInt<int64_t>(
+        GetParam(), std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+    CheckInt<int>(GetParam(), 42, 42);
+    CheckInt<int>(GetParam(), std::numeric_limits<int>::min(), std::numeric_limits<int>::min());
+    CheckInt<uint32_t>(
+        GetParam(), std::numeric_limits<uint32_t>::max(), std::numeric_limits<uint32_t>::max());
+}
+
+TEST_P(PhiloxBulkTest, UniformReal) {
+    const Philox4x32 engine{0x0123456789ABCDEF};
+    for (const auto& [from, to] : {std::pair{0.0, 1.0}, std::pair{-3.5, 1e6}}) {
+        for (const uint64_t first : kFirsts) {
+            for (const size_t count : kCounts) {
+                std::vector<double> bulk(count);
+                FillUniformReal(engine, first, bulk.data(), count, from, to, GetParam());
+                UniformRealDistribution dist{from, to};
+                for (size_t i = 0; i < count; ++i) {
+                    Philox4x32 gen = engine.Split(first + i);
+                    ASSERT_EQ(bulk[i], dist(gen)) << first << " " << i;
+                }
+            }
+        }
+    }
+}
+}  // namespace
@@ -0,0 +1,452 @@
+#pragma once
+
+#include "clock.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Scoped profiler: PROFILE_SCOPE("name") times the rest of the enclosing block as a child of
+// the innermost open scope on the same thread. Every thread accumulates into its own call
+// tree without locks or atomics; a thread's tree is merged into the profiler when the thread
+// exits. Reports cover the exited threads and the calling thread, so call them after
+// joining the workers. With tracing on, every scope also records an event for the Chrome
+// trace (chrome://tracing or ui.perfetto.dev).
+namespace profiler_detail {
+// Scopes are timed in raw ticks of the compile-time source of clock.h and converted to
+// nanoseconds only in the reports.
+inline uint64_t Now() {
+    return DefaultTicks::Now();
+}
+
+inline uint64_t ToNanoseconds(uint64_t ticks) {
+    return static_cast<uint64_t>(TicksToDuration(ticks).count());
+}
+
+// Log-linear histogram of durations in ticks: eight sub-buckets per power of two, so a
+// percentile is exact to within 1/16 of its value.
+class Histogram {
+   public:
+    void Add(uint64_t value) {
+        ++counts_[Bucket(value)];
+    }
+
+    void Merge(const Histogram& other) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+    }
+
+    // Midpoint of the bucket holding the q-quantile of count samples.
+    [[nodiscard]] uint64_t Percentile(double q, uint64_t count) const {
+        const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return Midpoint(i);
+            }
+        }
+        return 0;
+    }
+
+   private:
+    static constexpr size_t kSubBits = 3;
+    static constexpr size_t kSub = size_t{1} << kSubBits;
+    static constexpr size_t kBuckets = (64 - kSubBits + 1) * kSub;
+
+    static size_t Bucket(uint64_t value) {
+        if (value < kSub) {
+            return value;
+        }
+        const auto shift = static_cast<size_t>(std::bit_width(value)) - 1 - kSubBits;
+        return (shift + 1) * kSub + ((value >> shift) & (kSub - 1));
+    }
+
+    static uint64_t Midpoint(size_t bucket) {
+        if (bucket < kSub) {
+            return bucket;
+        }
+        const size_t shift = bucket / kSub - 1;
+        const uint64_t low = (kSub + bucket % kSub) << shift;
+        return low + ((uint64_t{1} << shift) >> 1U);
+    }
+
+    std::array<uint64_t, kBuckets> counts_{};
+};
+
+struct Stats {
+    uint64_t count = 0;
+    uint64_t total = 0;
+    uint64_t min = std::numeric_limits<uint64_t>::max();
+    uint64_t max = 0;
+    Histogram histogram;
+
+    void Add(uint64_t duration) {
+        ++count;
+        total += duration;
+        min = std::min(min, duration);
+        max = std::max(max, duration);
+        histogram.Add(duration);
+    }
+
+    void Merge(const Stats& other) {
+        count += other.count;
+        total += other.total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        histogram.Merge(other.histogram);
+    }
+
+    [[nodiscard]] uint64_t Percentile(double q) const {
+        return std::clamp(histogram.Percentile(q, count), min, max);
+    }
+};
+
+struct Node {
+    std::string name;
+    // Address of the name the node was opened with, so that scopes named by the same
+    // literal are matched without comparing strings.
+    const char* key = nullptr;
+    size_t parent = 0;
+    std::vector<size_t> children;
+    Stats stats;
+};
+
+// Call tree with the root at index 0. Children are matched by name.
+class Tree {
+   public:
+    Tree() : nodes_(1) {
+    }
+
+    // The children are first searched by the address of the name, which finds a scope
+    // opened from the same place without touching the strings; only on a miss are the names
+    // compared, and a match then takes over the new address.
+    size_t Child(size_t parent, const char* name) {
+        const std::vector<size_t>& children = nodes_[parent].children;
+        for (const size_t child : children) {
+            if (nodes_[child].key == name) {
+                return child;
+            }
+        }
+        for (const size_t child : children) {
+            if (nodes_[child].name == name) {
+                nodes_[child].key = name;
+                return child;
+            }
+        }
+        return AddChild(parent, name, name);
+    }
+
+    void Merge(const Tree& other) {
+        Merge(other, 0, 0);
+    }
+
+    [[nodiscard]] const Node& operator[](size_t node) const {
+        return nodes_[node];
+    }
+
+    Node& operator[](size_t node) {
+        return nodes_[node];
+    }
+
+    [[nodiscard]] size_t Size() const {
+        return nodes_.size();
+    }
+
+   private:
+    size_t AddChild(size_t parent, std::string name, const char* key) {
+        const size_t child = nodes_.size();
+        nodes_.push_back({std::move(name), key, parent, {}, {}});
+        nodes_[parent].children.push_back(child);
+        return child;
+    }
+
+    void Merge(const Tree& other, size_t from, size_t to) {
+        nodes_[to].stats.Merge(other.nodes_[from].stats);
+        for (const size_t other_child : other.nodes_[from].children) {
+            const std::string& name = other.nodes_[other_child].name;
+            size_t child = 0;
+            for (const size_t candidate : nodes_[to].children) {
+                if (nodes_[candidate].name == name) {
+                    child = candidate;
+                    break;
+                }
+            }
+            if (child == 0) {
+                child = AddChild(to, name, nullptr);
+            }
+            Merge(other, other_child, child);
+        }
+    }
+
+    std::vector<Node> nodes_;
+};
+
+struct Event {
+    size_t node;
+    uint64_t start;
+    uint64_t duration;
+};
+
+struct MergedEvent {
+    std::string name;
+    uint32_t thread;
+    uint64_t start;
+    uint64_t duration;
+};
+
+struct ThreadProfile;
+}  // namespace profiler_detail
+
+class Profiler {
+   public:
+    static Profiler& Instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+    Profiler(Profiler&&) = delete;
+    Profiler& operator=(Profiler&&) = delete;
+    ~Profiler() = default;
+
+    // Records every scope from now on for ChromeTrace(), up to kMaxTraceEvents per thread.
+    void SetTracing(bool enabled) {
+        tracing_.store(enabled, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool Tracing() const {
+        return tracing_.load(std::memory_order_relaxed);
+    }
+
+    // One line per scope name, over all the places it was opened, by total time.
+    [[nodiscard]] std::string FlatReport();
+
+    // The merged call tree, children indented under their parents.
+    [[nodiscard]] std::string TreeReport();
+
+    // Trace Event Format JSON with one complete event per recorded scope.
+    [[nodiscard]] std::string ChromeTrace();
+
+    static constexpr size_t kMaxTraceEvents = size_t{1} << 20U;
+
+   private:
+    friend struct profiler_detail::ThreadProfile;
+
+    Profiler() = default;
+
+    void Retire(profiler_detail::ThreadProfile& profile);
+    std::pair<profiler_detail::Tree, std::vector<profiler_detail::MergedEvent>> Snapshot();
+
+    std::mutex mutex_;
+    profiler_detail::Tree retired_;
+    std::vector<profiler_detail::MergedEvent> retired_events_;
+    std::atomic<bool> tracing_ = false;
+    std::atomic<uint32_t> next_thread_ = 0;
+    const uint64_t start_ = StartTicks();
+};
+
+namespace profiler_detail {
+struct ThreadProfile {
+    // Profiler::Instance() is constructed first, so it is destroyed after every thread's
+    // profile, including the main thread's.
+    ThreadProfile() : thread{Profiler::Instance().next_thread_.fetch_add(1)} {
+    }
+
+    ThreadProfile(const ThreadProfile&) = delete;
+    ThreadProfile& operator=(const ThreadProfile&) = delete;
+    ThreadProfile(ThreadProfile&&) = delete;
+    ThreadProfile& operator=(ThreadProfile&&) = delete;
+
+    ~ThreadProfile() {
+        Profiler::Instance().Retire(*this);
+    }
+
+    static ThreadProfile& Current() {
+        thread_local ThreadProfile profile;
+        return profile;
+    }
+
+    uint32_t thread;
+    Tree tree;
+    size_t current = 0;
+    std::vector<Event> events;
+};
+
+inline std::string FormatDuration(uint64_t ticks) {
+    const uint64_t ns = ToNanoseconds(ticks);
+    constexpr std::array<std::pair<double, const char*>, 3> kUnits{
+        {{1e9, "s"}, {1e6, "ms"}, {1e3, "us"}}};
+    std::array<char, 32> buffer{};
+    for (const auto& [scale, unit] : kUnits) {
+        if (static_cast<double>(ns) >= scale) {
+            std::snprintf(
+                buffer.data(), buffer.size(), "%.3f %s", static_cast<double>(ns) / scale, unit);
+            return buffer.data();
+        }
+    }
+    std::snprintf(buffer.data(), buffer.size(), "%llu ns", static_cast<unsigned long long>(ns));
+    return buffer.data();
+}
+
+inline void AppendHeader(std::string& out) {
+    std::array<char, 160> line{};
+    std::snprintf(
+        line.data(), line.size(), "%-40s %10s %12s %12s %12s %12s %12s\n", "scope", "count",
+        "total", "min", "p50", "p99", "max");
+    out += line.data();
+}
+
+inline void AppendRow(std::string& out, std::string_view name, const Stats& stats) {
+    std::array<char, 256> line{};
+    std::snprintf(
+        line.data(), line.size(), "%-40.*s %10llu %12s %12s %12s %12s %12s\n",
+        static_cast<int>(name.size()), name.data(), static_cast<unsigned long long>(stats.count),
+        FormatDuration(stats.total).c_str(), FormatDuration(stats.min).c_str(),
+        FormatDuration(stats.Percentile(0.5)).c_str(),
+        FormatDuration(stats.Percentile(0.99)).c_str(), FormatDuration(stats.max).c_str());
+    out += line.data();
+}
+
+inline void AppendTree(std::string& out, const Tree& tree, size_t node, size_t depth) {
+    for (const size_t child : tree[node].children) {
+        AppendRow(out, std::string(2 * depth, ' ') + tree[child].name, tree[child].stats);
+        AppendTree(out, tree, child, depth + 1);
+    }
+}
+
+inline void AppendJsonString(std::string& out, std::string_view text) {
+    out += '"';
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            std::array<char, 8> escaped{};
+            std::snprintf(escaped.data(), escaped.size(), "\\u%04x", c);
+            out += escaped.data();
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+}  // namespace profiler_detail
+
+// Times its lifetime as a child of the innermost open scope of the thread. The name must
+// outlive the thread, a string literal in practice.
+class ProfileScope {
+   public:
+    explicit ProfileScope(const char* name)
+        : profile_{profiler_detail::ThreadProfile::Current()}
+        , parent_{profile_.current}
+        , start_{profiler_detail::Now()} {
+        profile_.current = profile_.tree.Child(parent_, name);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+    ProfileScope(ProfileScope&&) = delete;
+    ProfileScope& operator=(ProfileScope&&) = delete;
+
+    ~ProfileScope() {
+        const uint64_t duration = profiler_detail::Now() - start_;
+        profile_.tree[profile_.current].stats.Add(duration);
+        if (Profiler::Instance().Tracing() && profile_.events.size() < Profiler::kMaxTraceEvents) {
+            profile_.events.push_back({profile_.current, start_, duration});
+        }
+        profile_.current = parent_;
+    }
+
+   private:
+    profiler_detail::ThreadProfile& profile_;
+    size_t parent_;
+    uint64_t start_;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) const ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__){name}
+
+inline void Profiler::Retire(profiler_detail::ThreadProfile& profile) {
+    const std::lock_guard lock{mutex_};
+    retired_.Merge(profile.tree);
+    for (const auto& event : profile.events) {
+        retired_events_.push_back(
+            {profile.tree[event.node].name, profile.thread, event.start, event.duration});
+    }
+}
+
+inline std::pair<profiler_detail::Tree, std::vector<profiler_detail::MergedEvent>>
+Profiler::Snapshot() {
+    auto& current = profiler_detail::ThreadProfile::Current();
+    const std::lock_guard lock{mutex_};
+    std::pair result{retired_, retired_events_};
+    result.first.Merge(current.tree);
+    for (const auto& event : current.events) {
+        result.second.push_back(
+            {current.tree[event.node].name, current.thread, event.start, event.duration});
+    }
+    return result;
+}
+
+inline std::string Profiler::FlatReport() {
+    const profiler_detail::Tree tree = Snapshot().first;
+    std::map<std::string_view, profiler_detail::Stats> by_name;
+    for (size_t node = 1; node < tree.Size(); ++node) {
+        by_name[tree[node].name].Merge(tree[node].stats);
+    }
+    std::vector<std::pair<std::string_view, const profiler_detail::Stats*>> rows;
+    rows.reserve(by_name.size());
+    for (const auto& [name, stats] : by_name) {
+        rows.emplace_back(name, &stats);
+    }
+    std::ranges::stable_sort(
+        rows, [](const auto& l, const auto& r) { return l.second->total > r.second->total; });
+    std::string out;
+    profiler_detail::AppendHeader(out);
+    for (const auto& [name, stats] : rows) {
+        profiler_detail::AppendRow(out, name, *stats);
+    }
+    return out;
+}
+
+inline std::string Profiler::TreeReport() {
+    const profiler_detail::Tree tree = Snapshot().first;
+    std::string out;
+    profiler_detail::AppendHeader(out);
+    profiler_detail::AppendTree(out, tree, 0, 0);
+    return out;
+}
+
+inline std::string Profiler::ChromeTrace() {
+    const auto events = Snapshot().second;
+    std::string out = R"({"displayTimeUnit":"ns","traceEvents":[)";
+    std::array<char, 96> fields{};
+    for (size_t i = 0; i < events.size(); ++i) {
+        const auto& event = events[i];
+        out += i == 0 ? "\n{\"name\":" : ",\n{\"name\":";
+        profiler_detail::AppendJsonString(out, event.name);
+        std::snprintf(
+            fields.data(), fields.size(), R"(,"ph":"X","pid":1,"tid":%u,"ts":%.3f,"dur":%.3f})",
+            event.thread,
+            static_cast<double>(profiler_detail::ToNanoseconds(event.start - start_)) / 1e3,
+            static_cast<double>(profiler_detail::ToNanoseconds(event.duration)) / 1e3);
+        out += fields.data();
+    }
+    out += "\n]}\n";
+    return out;
+}
@@ -0,0 +1,149 @@
+#include "profiler.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+using profiler_detail::Stats;
+using profiler_detail::Tree;
+
+// Count column of the report row whose scope column is exactly `scope`, indentation
+// included; -1 when there is no such row.
+int64_t ReportCount(const std::string& report, const std::string& scope) {
+    std::istringstream lines{report};
+    for (std::string line; std::getline(lines, line);) {
+        // The scope column is 40 characters wide.
+        std::string column = line.substr(0, 40);
+        column.erase(column.find_last_not_of(' ') + 1);
+        if (column == scope) {
+            unsigned long long count = 0;
+            if (std::sscanf(line.c_str() + 40, "%llu", &count) == 1) {
+                return static_cast<int64_t>(count);
+            }
+        }
+    }
+    return -1;
+}
+
+TEST(ProfilerTreeTest, ChildMatchesByAddressThenByName) {
+    Tree tree;
+    const char* literal = "scope";
+    const size_t child = tree.Child(0, literal);
+    EXPECT_EQ(tree.Child(0, literal), child);
+    // Same text at another address, e.g. the same name in another translation unit.
+    const std::string copy = literal;
+    EXPECT_EQ(tree.Child(0, copy.c_str()), child);
+    EXPECT_EQ(tree[child].key, copy.c_str());
+    EXPECT_EQ(tree.Child(0, literal), child);
+
+    const size_t other = tree.Child(0, "other");
+    EXPECT_NE(other, child);
+    EXPECT_NE(tree.Child(child, literal), child);
+    EXPECT_EQ(tree.Size(), 4U);
+}
+
+TEST(ProfilerTreeTest, MergeAddsStatsByName) {
+    Tree first;
+    Tree second;
+    const size_t outer = first.Child(0, "outer");
+    first[first.Child(outer, "inner")].stats.Add(10);
+    first[outer].stats.Add(30);
+
+    const std::string outer_name = "outer";
+    const size_t other_outer = second.Child(0, outer_name.c_str());
+    second[second.Child(other_outer, "inner")].stats.Add(5);
+    second[second.Child(other_outer, "extra")].stats.Add(1);
+    second[other_outer].stats.Add(20);
+
+    first.Merge(second);
+    ASSERT_EQ(first[0].children.size(), 1U);
+    const Stats& merged = first[outer].stats;
+    EXPECT_EQ(merged.count, 2U);
+    EXPECT_EQ(merged.total, 50U);
+    EXPECT_EQ(merged.min, 20U);
+    EXPECT_EQ(merged.max, 30U);
+    ASSERT_EQ(first[outer].children.size(), 2U);
+    const Stats& inner = first[first.Child(outer, "inner")].stats;
+    EXPECT_EQ(inner.count, 2U);
+    EXPECT_EQ(inner.total, 15U);
+}
+
+TEST(ProfilerStatsTest, PercentilesStayWithinMinAndMax) {
+    Stats stats;
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        stats.Add(value);
+    }
+    EXPECT_EQ(stats.count, 1000U);
+    EXPECT_EQ(stats.total, 500'500U);
+    // Buckets are exact to within 1/16 of the value.
+    EXPECT_NEAR(static_cast<double>(stats.Percentile(0.5)), 500, 500.0 / 16);
+    EXPECT_NEAR(static_cast<double>(stats.Percentile(0.99)), 990, 990.0 / 16);
+    EXPECT_LE(stats.Percentile(1), 1000U);
+    EXPECT_GE(stats.Percentile(0), 1U);
+}
+
+// The profiler is a process-wide singleton, so the tests below use scope names of their
+// own.
+TEST(ProfilerTest, NestedScopes) {
+    for (int i = 0; i < 3; ++i) {
+        PROFILE_SCOPE("nested_outer");
+        for (int j = 0; j < 4; ++j) {
+            PROFILE_SCOPE("nested_inner");
+        }
+    }
+    {
+        PROFILE_SCOPE("nested_inner");
+    }
+    const std::string tree = Profiler::Instance().TreeReport();
+    EXPECT_EQ(ReportCount(tree, "nested_outer"), 3);
+    EXPECT_EQ(ReportCount(tree, "  nested_inner"), 12);
+    EXPECT_EQ(ReportCount(tree, "nested_inner"), 1);
+    // The flat report adds up every place a name was opened.
+    EXPECT_EQ(ReportCount(Profiler::Instance().FlatReport(), "nested_inner"), 13);
+}
+
+// Worker trees are merged into the profiler when the threads exit.
+TEST(ProfilerTest, ThreadsMergeOnExit) {
+    constexpr int kThreads = 4;
+    constexpr int kScopes = 100;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([] {
+            PROFILE_SCOPE("merge_worker");
+            for (int i = 0; i < kScopes; ++i) {
+                PROFILE_SCOPE("merge_item");
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const std::string tree = Profiler::Instance().TreeReport();
+    EXPECT_EQ(ReportCount(tree, "merge_worker"), kThreads);
+    EXPECT_EQ(ReportCount(tree, "  merge_item"), kThreads * kScopes);
+}
+
+TEST(ProfilerTest, ChromeTraceHasOneEventPerScope) {
+    Profiler::Instance().SetTracing(true);
+    for (int i = 0; i < 5; ++i) {
+        PROFILE_SCOPE("trace_\"quoted\"");
+    }
+    Profiler::Instance().SetTracing(false);
+    {
+        PROFILE_SCOPE("trace_\"quoted\"");
+    }
+    const std::string trace = Profiler::Instance().ChromeTrace();
+    size_t events = 0;
+    for (size_t pos = trace.find(R"("name":"trace_\"quoted\"")"); pos != std::string::npos;
+         pos = trace.find(R"("name":"trace_\"quoted\"")", pos + 1)) {
+        ++events;
+    }
+    EXPECT_EQ(events, 5U);
+}
+}  // namespace
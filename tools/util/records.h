@@ -0,0 +1,291 @@
+#pragma once
+
+#include "dist.h"
+#include "parallel.h"
+#include "philox.h"
+#include "philox_bulk.h"
+
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class ColumnKind { kInt64, kReal, kString, kDate, kEnum, kZipf };
+
+// One column of a generated table; build it with the factory functions.
+struct ColumnSpec {
+    std::string name;
+    ColumnKind kind = ColumnKind::kInt64;
+    // Value bounds of kInt64 and kDate (days since 1970-01-01), length bounds of kString,
+    // n of kZipf.
+    int64_t min = 0;
+    int64_t max = 0;
+    double real_min = 0;
+    double real_max = 1;
+    double exponent = 1;
+    // Relative frequencies of the enum labels or of the string lengths min..max; empty means
+    // uniform.
+    std::vector<double> weights = {};
+    std::vector<std::string> labels = {};
+
+    static ColumnSpec Int(std::string name, int64_t from, int64_t to) {
+        return {.name = std::move(name), .kind = ColumnKind::kInt64, .min = from, .max = to};
+    }
+
+    static ColumnSpec Real(std::string name, double from, double to) {
+        return {
+            .name = std::move(name), .kind = ColumnKind::kReal, .real_min = from, .real_max = to};
+    }
+
+    static ColumnSpec String(
+        std::string name, int64_t min_length, int64_t max_length,
+        std::vector<double> length_weights = {}) {  // NOLINT
+        return {
+            .name = std::move(name),
+            .kind = ColumnKind::kString,
+            .min = min_length,
+            .max = max_length,
+            .weights = std::move(length_weights)};
+    }
+
+    static ColumnSpec Date(std::string name, std::chrono::sys_days from, std::chrono::sys_days to) {
+        return {
+            .name = std::move(name),
+            .kind = ColumnKind::kDate,
+            .min = from.time_since_epoch().count(),
+            .max = to.time_since_epoch().count()};
+    }
+
+    static ColumnSpec Enum(
+        std::string name, std::vector<std::string> labels,
+        std::vector<double> weights = {}) {  // NOLINT
+        return {
+            .name = std::move(name),
+            .kind = ColumnKind::kEnum,
+            .weights = std::move(weights),
+            .labels = std::move(labels)};
+    }
+
+    // Keys 1..n with P(k) ~ k^-exponent, i.e. a few hot keys and a long tail.
+    static ColumnSpec Zipf(std::string name, int64_t n, double exponent) {
+        return {.name = std::move(name), .kind = ColumnKind::kZipf, .max = n, .exponent = exponent};
+    }
+};
+
+// Generated values of one column, stored contiguously.
+struct ColumnData {
+    std::string name;
+    ColumnKind kind = ColumnKind::kInt64;
+    // kInt64, kDate (days since 1970-01-01), kEnum (index into labels) and kZipf values.
+    std::vector<int64_t> ints;
+    std::vector<double> reals;
+    // kString: row i is chars[offsets[i], offsets[i + 1]).
+    std::vector<char> chars;
+    std::vector<uint64_t> offsets;
+    std::vector<std::string> labels;
+
+    [[nodiscard]] std::string_view String(size_t row) const {
+        return {chars.data() + offsets[row], offsets[row + 1] - offsets[row]};
+    }
+
+    [[nodiscard]] size_t Bytes() const {
+        return ints.size() * sizeof(int64_t) + reals.size() * sizeof(double) + chars.size() +
+               offsets.size() * sizeof(uint64_t);
+    }
+};
+
+struct RecordBatch {
+    size_t rows = 0;
+    std::vector<ColumnData> columns;
+
+    [[nodiscard]] size_t Bytes() const {
+        size_t bytes = 0;
+        for (const auto& column : columns) {
+            bytes += column.Bytes();
+        }
+        return bytes;
+    }
+};
+
+// Generates typed rows from a schema, in parallel and reproducibly: every column has its own
+// Philox key derived from the seed, and row r of a column is drawn from stream r of that
+// key. The output depends only on the seed, the schema and the total number of rows
+// generated before, never on the thread count or on how the rows are split into batches.
+class RecordGenerator {
+   public:
+    explicit RecordGenerator(
+        std::vector<ColumnSpec> schema,
+        uint64_t seed = 738'547'485U,  // NOLINT(fuchsia-default-arguments-declarations)
+        unsigned threads = std::thread::hardware_concurrency())  // NOLINT
+        : schema_{std::move(schema)}, threads_{std::max(threads, 1U)} {
+        for (size_t column = 0; column < schema_.size(); ++column) {
+            const ColumnSpec& spec = schema_[column];
+            if (spec.min > spec.max && spec.kind != ColumnKind::kZipf) {
+                throw std::invalid_argument{"Empty range in column " + spec.name};
+            }
+            if (spec.kind == ColumnKind::kEnum && spec.labels.empty()) {
+                throw std::invalid_argument{"No labels in column " + spec.name};
+            }
+            // Extra weights would make DiscreteDistribution return indices past the labels.
+            if (spec.kind == ColumnKind::kEnum && !spec.weights.empty() &&
+                spec.weights.size() != spec.labels.size()) {
+                throw std::invalid_argument{"One weight per label needed in column " + spec.name};
+            }
+            if (spec.kind == ColumnKind::kString && spec.min < 0) {
+                throw std::invalid_argument{"Negative length in column " + spec.name};
+            }
+            if (spec.kind == ColumnKind::kString && !spec.weights.empty() &&
+                spec.weights.size() != static_cast<size_t>(spec.max - spec.min + 1)) {
+                throw std::invalid_argument{"One weight per length needed in column " + spec.name};
+            }
+            engines_.emplace_back(SplitMix64(seed + column * kGolden));
+        }
+    }
+
+    // The next `rows` rows of the table.
+    RecordBatch Generate(size_t rows) {
+        RecordBatch batch{rows, {}};
+        const uint64_t first = next_row_;
+        next_row_ += rows;
+        for (size_t column = 0; column < schema_.size(); ++column) {
+            const ColumnSpec& spec = schema_[column];
+            ColumnData& data = batch.columns.emplace_back();
+            data.name = spec.name;
+            data.kind = spec.kind;
+            data.labels = spec.labels;
+            GenerateColumn(spec, engines_[column], first, rows, data);
+        }
+        return batch;
+    }
+
+   private:
+    static constexpr uint64_t kGolden = 0x9E3779B97F4A7C15ULL;
+    static constexpr size_t kMinChunk = 4096;
+    // 64 symbols, so that one 32-bit output yields five characters without bias.
+    static constexpr std::string_view kAlphabet =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_";
+
+    static uint64_t SplitMix64(uint64_t x) {
+        x = (x ^ (x >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27U)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31U);
+    }
+
+    template <class Fn>
+    void ForChunks(size_t rows, const Fn& fn) const {
+        ParallelFor(rows, threads_, kMinChunk, fn);
+    }
+
+    // Draws row values whose distribution needs the whole stream of the row.
+    template <class Dist>
+    void FillPerRow(const Philox4x32& engine, uint64_t first, const Dist& dist, int64_t* out,
+                    size_t rows) const {
+        ForChunks(rows, [&](size_t begin, size_t end) {
+            Dist local = dist;
+            for (auto i = begin; i < end; ++i) {
+                Philox4x32 gen = engine.Split(first + i);
+                out[i] = static_cast<int64_t>(local(gen));
+            }
+        });
+    }
+
+    void GenerateColumn(
+        const ColumnSpec& spec, const Philox4x32& engine, uint64_t first, size_t rows,
+        ColumnData& data) const {
+        switch (spec.kind) {
+            case ColumnKind::kInt64:
+            case ColumnKind::kDate:
+                data.ints.resize(rows);
+                ForChunks(rows, [&](size_t begin, size_t end) {
+                    FillUniformInt(
+                        engine, first + begin, data.ints.data() + begin, end - begin, spec.min,
+                        spec.max);
+                });
+                break;
+            case ColumnKind::kReal:
+                data.reals.resize(rows);
+                ForChunks(rows, [&](size_t begin, size_t end) {
+                    FillUniformReal(
+                        engine, first + begin, data.reals.data() + begin, end - begin,
+                        spec.real_min, spec.real_max);
+                });
+                break;
+            case ColumnKind::kEnum:
+                data.ints.resize(rows);
+                if (spec.weights.empty()) {
+                    const auto last = static_cast<int64_t>(spec.labels.size()) - 1;
+                    ForChunks(rows, [&](size_t begin, size_t end) {
+                        FillUniformInt<int64_t>(
+                            engine, first + begin, data.ints.data() + begin, end - begin, 0,
+                            last);
+                    });
+                } else {
+                    FillPerRow(
+                        engine, first, DiscreteDistribution<int64_t>{spec.weights},
+                        data.ints.data(), rows);
+                }
+                break;
+            case ColumnKind::kZipf:
+                data.ints.resize(rows);
+                FillPerRow(
+                    engine, first, ZipfDistribution<int64_t>{spec.max, spec.exponent},
+                    data.ints.data(), rows);
+                break;
+            case ColumnKind::kString:
+                GenerateStrings(spec, engine, first, rows, data);
+                break;
+        }
+    }
+
+    // Row i's stream gives its length first and then its characters. The lengths are drawn
+    // in a first pass to lay out the offsets, and drawn again before the characters.
+    void GenerateStrings(
+        const ColumnSpec& spec, const Philox4x32& engine, uint64_t first, size_t rows,
+        ColumnData& data) const {
+        std::optional<DiscreteDistribution<int64_t>> weighted;
+        if (!spec.weights.empty()) {
+            weighted.emplace(spec.weights);
+        }
+        const auto length_of = [&](Philox4x32& gen) {
+            const int64_t length = weighted
+                                       ? spec.min + (*weighted)(gen)
+                                       : UniformIntDistribution<int64_t>{spec.min, spec.max}(gen);
+            return static_cast<uint64_t>(length);
+        };
+        data.offsets.assign(rows + 1, 0);
+        ForChunks(rows, [&](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                Philox4x32 gen = engine.Split(first + i);
+                data.offsets[i + 1] = length_of(gen);
+            }
+        });
+        std::partial_sum(data.offsets.begin(), data.offsets.end(), data.offsets.begin());
+        data.chars.resize(data.offsets.back());
+        ForChunks(rows, [&](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                Philox4x32 gen = engine.Split(first + i);
+                length_of(gen);
+                char* out = data.chars.data() + data.offsets[i];
+                char* const out_end = data.chars.data() + data.offsets[i + 1];
+                while (out != out_end) {
+                    uint32_t word = gen();
+                    for (int k = 0; k < 5 && out != out_end; ++k) {
+                        *out++ = kAlphabet[word & 63U];
+                        word >>= 6U;
+                    }
+                }
+            }
+        });
+    }
+
+    std::vector<ColumnSpec> schema_;
+    std::vector<Philox4x32> engines_;
+    unsigned threads_;
+    uint64_t next_row_ = 0;
+};
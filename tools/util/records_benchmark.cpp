@@ -0,0 +1,56 @@
+#include "perf_benchmark.h"
+#include "records.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+using std::chrono::December;
+using std::chrono::January;
+using std::chrono::sys_days;
+using std::chrono::year;
+
+std::vector<ColumnSpec> OrdersSchema() {
+    return {
+        ColumnSpec::Int("id", 0, 999'999'999),
+        ColumnSpec::Zipf("customer", 1'000'000, 1.1),
+        ColumnSpec::Real("amount", 0, 1000),
+        ColumnSpec::String("comment", 8, 64),
+        ColumnSpec::Date(
+            "day", sys_days{year{2020} / January / 1}, sys_days{year{2024} / December / 31}),
+        ColumnSpec::Enum("status", {"new", "paid", "shipped", "returned"}, {40, 30, 25, 5}),
+    };
+}
+
+// Rows per iteration x threads.
+void BM_GenerateRecords(benchmark::State& state) {
+    const auto rows = static_cast<size_t>(state.range(0));
+    RecordGenerator generator{OrdersSchema(), 1, static_cast<unsigned>(state.range(1))};
+    size_t bytes = 0;
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        const RecordBatch batch = generator.Generate(rows);
+        bytes += batch.Bytes();
+        benchmark::DoNotOptimize(batch.columns.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * rows));
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+void GenerateRecordsArgs(benchmark::internal::Benchmark* b) {
+    const auto threads = static_cast<int64_t>(std::max(std::thread::hardware_concurrency(), 1U));
+    for (const int64_t rows : {100'000, 1'000'000}) {
+        b->Args({rows, 1});
+        if (threads > 1) {
+            b->Args({rows, threads});
+        }
+    }
+}
+}  // namespace
+
+BENCHMARK(BM_GenerateRecords)->Apply(GenerateRecordsArgs)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,128 @@
+#include "records.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+using std::chrono::days;
+using std::chrono::sys_days;
+
+// Enough rows for several chunks of RecordGenerator::kMinChunk (4096) per thread.
+constexpr size_t kRows = 20'000;
+
+std::vector<ColumnSpec> Schema() {
+    return {
+        ColumnSpec::Int("id", -5, 1'000'000),
+        ColumnSpec::Real("price", 0.5, 99.5),
+        ColumnSpec::String("name", 0, 12),
+        ColumnSpec::String("code", 2, 4, {1, 0, 3}),
+        ColumnSpec::Date("day", sys_days{days{18'000}}, sys_days{days{19'000}}),
+        ColumnSpec::Enum("color", {"red", "green", "blue"}),
+        ColumnSpec::Enum("size", {"S", "M", "L"}, {1, 2, 0}),
+        ColumnSpec::Zipf("product", 1000, 1.1),
+    };
+}
+
+void ExpectEqual(const RecordBatch& a, const RecordBatch& b) {
+    ASSERT_EQ(a.rows, b.rows);
+    ASSERT_EQ(a.columns.size(), b.columns.size());
+    for (size_t i = 0; i < a.columns.size(); ++i) {
+        SCOPED_TRACE(a.columns[i].name);
+        EXPECT_EQ(a.columns[i].ints, b.columns[i].ints);
+        EXPECT_EQ(a.columns[i].reals, b.columns[i].reals);
+        EXPECT_EQ(a.columns[i].chars, b.columns[i].chars);
+        EXPECT_EQ(a.columns[i].offsets, b.columns[i].offsets);
+    }
+}
+
+RecordBatch Concat(const RecordBatch& a, const RecordBatch& b) {
+    RecordBatch result = a;
+    result.rows += b.rows;
+    for (size_t i = 0; i < result.columns.size(); ++i) {
+        ColumnData& column = result.columns[i];
+        const ColumnData& tail = b.columns[i];
+        column.ints.insert(column.ints.end(), tail.ints.begin(), tail.ints.end());
+        column.reals.insert(column.reals.end(), tail.reals.begin(), tail.reals.end());
+        column.chars.insert(column.chars.end(), tail.chars.begin(), tail.chars.end());
+        if (!tail.offsets.empty()) {
+            const uint64_t base = column.offsets.back();
+            for (size_t row = 1; row < tail.offsets.size(); ++row) {
+                column.offsets.push_back(base + tail.offsets[row]);
+            }
+        }
+    }
+    return result;
+}
+
+TEST(RecordGeneratorTest, DoesNotDependOnThreads) {
+    RecordGenerator single{Schema(), 42, 1};
+    const RecordBatch expected = single.Generate(kRows);
+    for (const unsigned threads : {2U, 3U, 8U}) {
+        SCOPED_TRACE(threads);
+        RecordGenerator parallel{Schema(), 42, threads};
+        ExpectEqual(parallel.Generate(kRows), expected);
+    }
+}
+
+TEST(RecordGeneratorTest, DoesNotDependOnBatches) {
+    RecordGenerator whole{Schema(), 7, 4};
+    RecordGenerator parts{Schema(), 7, 2};
+    const RecordBatch expected = whole.Generate(kRows);
+    const RecordBatch head = parts.Generate(kRows / 3);
+    ExpectEqual(Concat(head, parts.Generate(kRows - kRows / 3)), expected);
+}
+
+TEST(RecordGeneratorTest, SeedChangesValues) {
+    RecordGenerator a{Schema(), 1, 1};
+    RecordGenerator b{Schema(), 2, 1};
+    EXPECT_NE(a.Generate(100).columns[0].ints, b.Generate(100).columns[0].ints);
+}
+
+TEST(RecordGeneratorTest, ValuesInRange) {
+    RecordGenerator generator{Schema(), 3, 4};
+    const RecordBatch batch = generator.Generate(kRows);
+    for (const int64_t id : batch.columns[0].ints) {
+        ASSERT_TRUE(-5 <= id && id <= 1'000'000) << id;
+    }
+    for (const double price : batch.columns[1].reals) {
+        ASSERT_TRUE(0.5 <= price && price < 99.5) << price;
+    }
+    for (size_t row = 0; row < kRows; ++row) {
+        ASSERT_LE(batch.columns[2].String(row).size(), 12U);
+        const size_t code = batch.columns[3].String(row).size();
+        // The length 3 has weight zero.
+        ASSERT_TRUE(code == 2 || code == 4) << code;
+    }
+    for (const int64_t day : batch.columns[4].ints) {
+        ASSERT_TRUE(18'000 <= day && day <= 19'000) << day;
+    }
+    for (const int64_t color : batch.columns[5].ints) {
+        ASSERT_TRUE(0 <= color && color < 3) << color;
+    }
+    for (const int64_t size : batch.columns[6].ints) {
+        ASSERT_TRUE(size == 0 || size == 1) << size;
+    }
+    for (const int64_t product : batch.columns[7].ints) {
+        ASSERT_TRUE(1 <= product && product <= 1000) << product;
+    }
+    EXPECT_EQ(batch.columns[5].labels, (std::vector<std::string>{"red", "green", "blue"}));
+}
+
+TEST(RecordGeneratorTest, RejectsBadSpecs) {
+    const auto make = [](ColumnSpec spec) { return RecordGenerator{{std::move(spec)}, 1, 1}; };
+    EXPECT_THROW(make(ColumnSpec::Int("a", 5, 4)), std::invalid_argument);
+    EXPECT_THROW(make(ColumnSpec::String("a", -1, 4)), std::invalid_argument);
+    EXPECT_THROW(make(ColumnSpec::String("a", 1, 3, {1, 1})), std::invalid_argument);
+    EXPECT_THROW(make(ColumnSpec::Enum("a", {})), std::invalid_argument);
+    EXPECT_THROW(make(ColumnSpec::Enum("a", {"x", "y"}, {1, 1, 1})), std::invalid_argument);
+    EXPECT_THROW(make(ColumnSpec::Enum("a", {"x", "y"}, {1})), std::invalid_argument);
+    EXPECT_NO_THROW(make(ColumnSpec::Enum("a", {"x", "y"}, {1, 3})));
+}
+}  // namespace
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "dist.h"
+#include "parallel.h"
+#include "philox.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Parallel random-scatter shuffle (Sanders, "Random permutations on distributed, external and
+// hierarchical memory"): every element is sent to a uniformly random bucket, and each
+// bucket, small enough to stay in cache, is then shuffled with Fisher-Yates. The
+// concatenation of the buckets is a uniform permutation.
+//
+// Elements are dealt to buckets in fixed chunks of the input, each drawing from its own
+// Philox stream, and every bucket has its own stream for the Fisher-Yates pass. Chunks and
+// buckets depend only on the element count, so the result is a function of the key, the
+// first stream and the count, whatever the number of threads.
+namespace shuffle_detail {
+// Buckets of about this many elements fit in L2 for the usual 4- and 8-byte values.
+constexpr size_t kBucketSize = size_t{1} << 15U;
+// More buckets would scatter into too many pages at once for the TLB.
+constexpr size_t kMaxBuckets = 4096;
+static_assert(kMaxBuckets <= (size_t{1} << 16U));
+constexpr size_t kChunkSize = size_t{1} << 18U;
+constexpr size_t kMaxChunks = 256;
+
+struct Layout {
+    size_t chunks;
+    size_t buckets;
+
+    explicit Layout(size_t count)
+        : chunks{std::clamp<size_t>(count / kChunkSize, 1, kMaxChunks)}
+        , buckets{std::clamp<size_t>(std::bit_ceil(count / kBucketSize), 1, kMaxBuckets)} {
+    }
+
+    [[nodiscard]] size_t ChunkBegin(size_t count, size_t chunk) const {
+        return count * chunk / chunks;
+    }
+};
+
+// Uniform index in [0, range) with Lemire's method; the division is only needed for the
+// rare draws that land in the biased region.
+inline uint64_t BoundedDraw(Philox4x32& gen, uint64_t range) {
+    if (range <= std::numeric_limits<uint32_t>::max()) {
+        const auto narrow = static_cast<uint32_t>(range);
+        uint64_t product = uint64_t{gen()} * narrow;
+        if (static_cast<uint32_t>(product) < narrow) {
+            const uint32_t threshold = (0U - narrow) % narrow;
+            while (static_cast<uint32_t>(product) < threshold) {
+                product = uint64_t{gen()} * narrow;
+            }
+        }
+        return product >> 32U;
+    }
+    return UniformIntDistribution<uint64_t>{0, range - 1}(gen);
+}
+
+template <class T>
+void FisherYates(T* first, size_t count, Philox4x32 gen) {
+    for (size_t i = count; i > 1; --i) {
+        std::swap(first[i - 1], first[BoundedDraw(gen, i)]);
+    }
+}
+
+// Deals bucket indices from a chunk's stream, two per output: the bucket count is a power of
+// two no larger than 2^16, so a 16-bit half selects a bucket exactly.
+class BucketDealer {
+   public:
+    BucketDealer(Philox4x32 gen, size_t buckets)
+        : gen_{gen}, shift_{16 - std::countr_zero(buckets)} {
+    }
+
+    size_t operator()() {
+        if (halves_ == 0) {
+            word_ = gen_();
+            halves_ = 2;
+        }
+        --halves_;
+        const uint32_t half = word_ & 0xFFFFU;
+        word_ >>= 16U;
+        return half >> shift_;
+    }
+
+   private:
+    Philox4x32 gen_;
+    int shift_;
+    uint32_t word_ = 0;
+    int halves_ = 0;
+};
+
+// Writes a random permutation of source(0), ..., source(count - 1) to out and calls
+// bucket_done(begin, end) on every shuffled bucket while it is still in cache.
+template <class T, class Source, class BucketDone>
+void ScatterShuffle(
+    size_t count, const Philox4x32& engine, uint64_t first_stream, unsigned threads,
+    const Source& source, T* out, const BucketDone& bucket_done) {
+    const Layout layout{count};
+    const size_t buckets = layout.buckets;
+    // positions[chunk * buckets + bucket]: element counts, then scatter positions.
+    std::vector<size_t> positions(layout.chunks * buckets);
+    ParallelFor(layout.chunks, threads, 1, [&](size_t first_chunk, size_t last_chunk) {
+        for (auto chunk = first_chunk; chunk < last_chunk; ++chunk) {
+            BucketDealer deal{engine.Split(first_stream + chunk), buckets};
+            size_t* counts = positions.data() + chunk * buckets;
+            for (auto i = layout.ChunkBegin(count, chunk),
+                      end = layout.ChunkBegin(count, chunk + 1);
+                 i < end; ++i) {
+                ++counts[deal()];
+            }
+        }
+    });
+    std::vector<size_t> bucket_begin(buckets + 1);
+    size_t total = 0;
+    for (size_t bucket = 0; bucket < buckets; ++bucket) {
+        bucket_begin[bucket] = total;
+        for (size_t chunk = 0; chunk < layout.chunks; ++chunk) {
+            total += std::exchange(positions[chunk * buckets + bucket], total);
+        }
+    }
+    bucket_begin[buckets] = total;
+    ParallelFor(layout.chunks, threads, 1, [&](size_t first_chunk, size_t last_chunk) {
+        for (auto chunk = first_chunk; chunk < last_chunk; ++chunk) {
+            BucketDealer deal{engine.Split(first_stream + chunk), buckets};
+            size_t* next = positions.data() + chunk * buckets;
+            for (auto i = layout.ChunkBegin(count, chunk),
+                      end = layout.ChunkBegin(count, chunk + 1);
+                 i < end; ++i) {
+                out[next[deal()]++] = source(i);
+            }
+        }
+    });
+    ParallelFor(buckets, threads, 1, [&](size_t first_bucket, size_t last_bucket) {
+        for (auto bucket = first_bucket; bucket < last_bucket; ++bucket) {
+            const size_t begin = bucket_begin[bucket];
+            const size_t end = bucket_begin[bucket + 1];
+            FisherYates(
+                out + begin, end - begin, engine.Split(first_stream + layout.chunks + bucket));
+            bucket_done(begin, end);
+        }
+    });
+}
+}  // namespace shuffle_detail
+
+// Philox streams used by a shuffle of count elements, starting at first_stream.
+inline uint64_t ShuffleStreams(size_t count) {
+    const shuffle_detail::Layout layout{count};
+    return layout.chunks + layout.buckets;
+}
+
+// out[i] becomes a random permutation of 0, ..., count - 1.
+template <class T>
+void ParallelPermutation(
+    std::span<T> out, const Philox4x32& engine, uint64_t first_stream, unsigned threads) {
+    shuffle_detail::ScatterShuffle(
+        out.size(), engine, first_stream, threads, [](size_t i) { return static_cast<T>(i); },
+        out.data(), [](size_t, size_t) {});
+}
+
+// Shuffles data through a buffer of the same size.
+template <class T>
+void ParallelShuffle(
+    std::span<T> data, const Philox4x32& engine, uint64_t first_stream, unsigned threads) {
+    std::vector<T> buffer(data.size());
+    shuffle_detail::ScatterShuffle(
+        data.size(), engine, first_stream, threads,
+        [&data](size_t i) { return std::move(data[i]); }, buffer.data(),
+        [&](size_t begin, size_t end) {
+            std::move(buffer.begin() + begin, buffer.begin() + end, data.begin() + begin);
+        });
+}
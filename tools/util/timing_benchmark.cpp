@@ -0,0 +1,38 @@
+#include "clock.h"
+#include "perf_benchmark.h"
+#include "profiler.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+// Cost of one sample of each tick source.
+template <class Ticks>
+void BM_Ticks(benchmark::State& state) {
+    Ticks::NanosecondsPerTick();
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Ticks::Now());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ProfileScope(benchmark::State& state) {
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        PROFILE_SCOPE("benchmark");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_Ticks<SteadyTicks>);
+#ifdef __linux__
+BENCHMARK(BM_Ticks<ThreadCpuTicks>);
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+BENCHMARK(BM_Ticks<TscTicks>);
+BENCHMARK(BM_Ticks<TscpTicks>);
+#endif
+BENCHMARK(BM_ProfileScope);
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -1,12 +1,29 @@
 #pragma once
 
+#include "clock.h"
 #include "dist.h"
+#include "parallel.h"
+#include "philox.h"
+#include "philox_bulk.h"
+#include "profiler.h"
+#include "shuffle.h"
 
 #include <algorithm>
+#include <cerrno>
+#include <concepts>
 #include <cstdint>
 #include <filesystem>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <numeric>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #ifdef __linux__
@@ -14,46 +31,82 @@
 #include <sys/time.h>
 #endif
 
-class RandomGenerator {
+// Engines that can hand out independent streams, such as Philox4x32.
+template <class Engine>
+concept CounterBasedEngine = requires(const Engine& engine, uint64_t stream) {
+    { engine.Split(stream) } -> std::same_as<Engine>;
+};
+
+// With a counter-based engine every element of GenIntegralVector, GenRealVector and
+// GenString is drawn from its own stream, numbered by its position in the sequence of all
+// generated elements. Chunks are filled on up to `threads` threads, and the output depends
+// only on the seed: it is the same for any thread count, including one. Other engines draw
+// everything sequentially from the one engine, as std::mt19937 always did here, and ignore
+// `threads`.
+template <class Engine = std::mt19937>
+class BasicRandomGenerator {
    public:
-    explicit RandomGenerator(
-        uint32_t seed = 738'547'485U)  // NOLINT(fuchsia-default-arguments-declarations)
-        : gen_(seed) {
+    explicit BasicRandomGenerator(
+        uint32_t seed = 738'547'485U,  // NOLINT(fuchsia-default-arguments-declarations)
+        unsigned threads = DefaultThreads())  // NOLINT(fuchsia-default-arguments-declarations)
+        : gen_(MakeEngine(seed)), threads_{std::max(threads, 1U)} {
     }
 
     template <class T>
     std::vector<T> GenIntegralVector(size_t count, T from, T to) {
-        UniformIntDistribution dist{from, to};
         std::vector<T> result(count);
-        for (auto& cur : result) {
-            cur = dist(gen_);
-        }
+        Fill(
+            result,
+            [dist = UniformIntDistribution{from, to}](auto& gen) mutable { return dist(gen); },
+            [from, to](const auto& gen, uint64_t first, T* out, size_t size) {
+                FillUniformInt(gen, first, out, size, from, to);
+            });
         return result;
     }
 
     std::string GenString(
         size_t count, char from = 'a',  // NOLINT(fuchsia-default-arguments-declarations)
         char to = 'z') {                // NOLINT(fuchsia-default-arguments-declarations)
-        UniformIntDistribution<int> dist{from, to};
         std::string result(count, from);
-        for (char& x : result) {
-            x = static_cast<char>(dist(gen_));
-        }
+        Fill(
+            result,
+            [dist = UniformIntDistribution<int>{from, to}](auto& gen) mutable {
+                return static_cast<char>(dist(gen));
+            },
+            [from, to](const auto& gen, uint64_t first, char* out, size_t size) {
+                FillUniformInt<int>(gen, first, out, size, from, to);
+            });
         return result;
     }
 
     std::vector<double> GenRealVector(size_t count, double from, double to) {
-        UniformRealDistribution dist{from, to};
         std::vector<double> result(count);
-        for (auto& cur : result) {
-            cur = dist(gen_);
-        }
+        Fill(
+            result,
+            [dist = UniformRealDistribution{from, to}](auto& gen) mutable { return dist(gen); },
+            [from, to](const auto& gen, uint64_t first, double* out, size_t size) {
+                FillUniformReal(gen, first, out, size, from, to);
+            });
         return result;
     }
 
-    std::vector<int> GenPermutation(size_t count) {
-        std::vector<int> result(count);
-        std::iota(result.begin(), result.end(), 0);
+    // With a counter-based engine, permutations of kMinChunk or more elements use the
+    // parallel scatter shuffle of shuffle.h; pass a 64-bit T for more than INT_MAX elements.
+    template <class T = int>
+    std::vector<T> GenPermutation(size_t count) {
+        static_assert(std::is_integral_v<T>, "permutation elements must be integral");
+        if (count > 0 && count - 1 > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+            throw std::invalid_argument{"Permutation does not fit in the element type"};
+        }
+        std::vector<T> result(count);
+        if constexpr (CounterBasedEngine<Engine>) {
+            if (count >= kMinChunk) {
+                const auto [engine, first_stream] = ShuffleEngine(count);
+                ParallelPermutation(std::span{result}, engine, first_stream, threads_);
+                return result;
+            }
+        }
+        std::iota(result.begin(), result.end(), T{0});
         std::ranges::shuffle(result, gen_);
         return result;
     }
@@ -83,15 +136,99 @@ class RandomGenerator {
         return GenChar('a', 'z');
     }
 
+    // With a counter-based engine, contiguous ranges of kMinChunk or more default-constructible
+    // elements are shuffled in parallel through a temporary buffer, see shuffle.h.
     template <class Iterator>
     void Shuffle(Iterator first, Iterator last) {
+        using T = std::iter_value_t<Iterator>;
+        if constexpr (
+            CounterBasedEngine<Engine> && std::contiguous_iterator<Iterator> &&
+            std::is_default_constructible_v<T>) {
+            if (const auto count = static_cast<size_t>(last - first); count >= kMinChunk) {
+                const auto [engine, first_stream] = ShuffleEngine(count);
+                ParallelShuffle(
+                    std::span{std::to_address(first), count}, engine, first_stream, threads_);
+                return;
+            }
+        }
         std::shuffle(first, last, gen_);
     }
 
    private:
-    std::mt19937 gen_;
+    static unsigned DefaultThreads() {
+        return CounterBasedEngine<Engine> ? std::thread::hardware_concurrency() : 1U;
+    }
+
+    // Counter-based engines keep the last stream for the scalar members, so they never
+    // overlap with the per-element streams counted up from zero.
+    static Engine MakeEngine(uint32_t seed) {
+        if constexpr (CounterBasedEngine<Engine>) {
+            return Engine{seed, std::numeric_limits<uint64_t>::max()};
+        } else {
+            return Engine{seed};
+        }
+    }
+
+    // Philox fills go through the bulk kernels of philox_bulk.h, which produce the same
+    // values as drawing every element from its own stream. bulk_draw takes the engine as
+    // `const auto&`, so that its body, which only accepts Philox4x32, is not instantiated
+    // for other engines.
+    template <class Range, class Draw, class BulkDraw>
+    void Fill(Range& range, Draw draw, const BulkDraw& bulk_draw) {
+        if constexpr (std::same_as<Engine, Philox4x32>) {
+            const uint64_t first = next_stream_;
+            next_stream_ += range.size();
+            ParallelFor(range.size(), [&](size_t begin, size_t end) {
+                bulk_draw(gen_, first + begin, range.data() + begin, end - begin);
+            });
+        } else if constexpr (CounterBasedEngine<Engine>) {
+            const uint64_t first = next_stream_;
+            next_stream_ += range.size();
+            ParallelFor(range.size(), [&](size_t begin, size_t end) {
+                Draw local_draw = draw;
+                for (auto i = begin; i < end; ++i) {
+                    Engine gen = gen_.Split(first + i);
+                    range[i] = local_draw(gen);
+                }
+            });
+        } else {
+            for (auto& cur : range) {
+                cur = draw(gen_);
+            }
+        }
+    }
+
+    // Philox key and first stream for a parallel shuffle of count elements. Philox generators
+    // hand out the next unused streams; other counter-based engines seed a Philox key from
+    // two draws.
+    std::pair<Philox4x32, uint64_t> ShuffleEngine(size_t count) {
+        if constexpr (std::same_as<Engine, Philox4x32>) {
+            const uint64_t first = next_stream_;
+            next_stream_ += ShuffleStreams(count);
+            return {gen_, first};
+        } else {
+            const auto high = static_cast<uint64_t>(gen_());
+            const auto low = static_cast<uint64_t>(gen_());
+            return {Philox4x32{(high << 32U) ^ low}, 0};
+        }
+    }
+
+    template <class Fn>
+    void ParallelFor(size_t count, const Fn& fn) const {
+        ::ParallelFor(count, threads_, kMinChunk, fn);
+    }
+
+    // Below this many elements per thread, starting a thread costs more than it saves.
+    static constexpr size_t kMinChunk = 1 << 16;
+
+    Engine gen_;
+    unsigned threads_;
+    uint64_t next_stream_ = 0;
 };
 
+using RandomGenerator = BasicRandomGenerator<>;
+using ParallelRandomGenerator = BasicRandomGenerator<Philox4x32>;
+
 inline std::filesystem::path GetFileDir(std::string file, bool without_check = false) {  // NOLINT
     const std::filesystem::path path{std::move(file)};
     if (without_check) {
@@ -103,17 +240,23 @@ inline std::filesystem::path GetFileDir(std::string file, bool without_check = f
     throw std::runtime_error{"Bad file name"};
 }
 
-class Timer {
-    using Clock = std::chrono::steady_clock;
-
+// Time of the tick source (see clock.h) and user CPU time since construction. For named,
+// nested scopes aggregated over threads use PROFILE_SCOPE from profiler.h.
+template <class Ticks = DefaultTicks>
+class BasicTimer {
     struct Times {
-        Clock::duration wall_time;
+        std::chrono::nanoseconds wall_time;
         std::chrono::microseconds cpu_time;
     };
 
    public:
     [[nodiscard]] Times GetTimes() const {
-        return {Clock::now() - wall_start_, GetCPUTime() - cpu_start_};
+        return {Elapsed(), GetCPUTime() - cpu_start_};
+    }
+
+    // Only the tick source, without the getrusage call of GetTimes.
+    [[nodiscard]] std::chrono::nanoseconds Elapsed() const {
+        return TicksToDuration<Ticks>(Ticks::Now() - start_);
     }
 
    private:
@@ -126,15 +269,17 @@ class Timer {
         auto time = usage.ru_utime;
         return std::chrono::microseconds{1'000'000LL * time.tv_sec + time.tv_usec};
 #else
-        auto time = Clock::now().time_since_epoch();
+        auto time = std::chrono::steady_clock::now().time_since_epoch();
         return std::chrono::duration_cast<std::chrono::microseconds>(time);
 #endif
     }
 
-    std::chrono::time_point<Clock> wall_start_ = Clock::now();
+    uint64_t start_ = StartTicks<Ticks>();
     std::chrono::microseconds cpu_start_ = GetCPUTime();
 };
 
+using Timer = BasicTimer<>;
+
 #ifdef __linux__
 #include <fstream>
 #include <unistd.h>
@@ -0,0 +1,136 @@
+#include "util.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+// BasicRandomGenerator::kMinChunk: the parallel paths start at this size, and chunks of it
+// are what the threads split.
+constexpr size_t kMinChunk = 1 << 16;
+constexpr std::array<size_t, 6> kSizes = {
+    0, 1000, kMinChunk - 1, kMinChunk, kMinChunk + 1, 4 * kMinChunk + 3};
+constexpr std::array<unsigned, 2> kThreads = {3, 8};
+
+template <class T>
+bool IsPermutation(const std::vector<T>& values) {
+    std::vector<bool> seen(values.size());
+    for (const T value : values) {
+        const auto index = static_cast<size_t>(value);
+        if (value < 0 || index >= values.size() || seen[index]) {
+            return false;
+        }
+        seen[index] = true;
+    }
+    return true;
+}
+
+template <class Generator>
+class RandomGeneratorTest : public testing::Test {};
+
+using Generators = testing::Types<RandomGenerator, ParallelRandomGenerator>;
+TYPED_TEST_SUITE(RandomGeneratorTest, Generators);
+
+TYPED_TEST(RandomGeneratorTest, PermutationDoesNotDependOnThreads) {
+    TypeParam single{42, 1};
+    std::vector<TypeParam> parallel;
+    for (const unsigned threads : kThreads) {
+        parallel.emplace_back(42, threads);
+    }
+    for (const size_t size : kSizes) {
+        const std::vector<int> expected = single.template GenPermutation<int>(size);
+        ASSERT_TRUE(IsPermutation(expected)) << size;
+        for (auto& generator : parallel) {
+            ASSERT_EQ(generator.template GenPermutation<int>(size), expected) << size;
+        }
+        const auto wide = single.template GenPermutation<int64_t>(size);
+        ASSERT_TRUE(IsPermutation(wide)) << size;
+        for (auto& generator : parallel) {
+            ASSERT_EQ(generator.template GenPermutation<int64_t>(size), wide) << size;
+        }
+    }
+}
+
+TYPED_TEST(RandomGeneratorTest, ShuffleDoesNotDependOnThreads) {
+    TypeParam single{7, 1};
+    std::vector<TypeParam> parallel;
+    for (const unsigned threads : kThreads) {
+        parallel.emplace_back(7, threads);
+    }
+    for (const size_t size : kSizes) {
+        std::vector<int64_t> expected(size);
+        std::iota(expected.begin(), expected.end(), 0);
+        single.Shuffle(expected.begin(), expected.end());
+        ASSERT_TRUE(IsPermutation(expected)) << size;
+        for (auto& generator : parallel) {
+            std::vector<int64_t> values(size);
+            std::iota(values.begin(), values.end(), 0);
+            generator.Shuffle(values.begin(), values.end());
+            ASSERT_EQ(values, expected) << size;
+        }
+    }
+}
+
+TYPED_TEST(RandomGeneratorTest, IntegralVectorDoesNotDependOnThreads) {
+    TypeParam single{1234, 1};
+    std::vector<TypeParam> parallel;
+    for (const unsigned threads : kThreads) {
+        parallel.emplace_back(1234, threads);
+    }
+    for (const size_t size : kSizes) {
+        const auto expected = single.GenIntegralVector(size, -1000, 1000);
+        ASSERT_EQ(expected.size(), size);
+        ASSERT_TRUE(std::ranges::all_of(expected, [](int x) { return -1000 <= x && x <= 1000; }));
+        for (auto& generator : parallel) {
+            ASSERT_EQ(generator.GenIntegralVector(size, -1000, 1000), expected) << size;
+        }
+        const auto full = single.template GenIntegralVector<uint64_t>(
+            size, 0, std::numeric_limits<uint64_t>::max());
+        for (auto& generator : parallel) {
+            ASSERT_EQ(
+                generator.template GenIntegralVector<uint64_t>(
+                    size, 0, std::numeric_limits<uint64_t>::max()),
+                full)
+                << size;
+        }
+    }
+}
+
+// RandomGenerator keeps its original output: the std::mt19937 sequence, used sequentially
+// whatever the size or thread count.
+TEST(RandomGeneratorTest, MatchesMersenneTwister) {
+    for (const size_t size : kSizes) {
+        RandomGenerator generator{5, 8};
+        std::mt19937 engine{5};
+        std::vector<int> expected(size);
+        std::iota(expected.begin(), expected.end(), 0);
+        std::ranges::shuffle(expected, engine);
+        ASSERT_EQ(generator.GenPermutation(size), expected) << size;
+
+        std::vector<int64_t> values(size);
+        std::iota(values.begin(), values.end(), 0);
+        std::vector<int64_t> shuffled = values;
+        generator.Shuffle(values.begin(), values.end());
+        std::shuffle(shuffled.begin(), shuffled.end(), engine);
+        ASSERT_EQ(values, shuffled) << size;
+    }
+}
+
+// Streams are numbered across calls, so two calls give the same values as one call of the
+// combined size.
+TEST(ParallelRandomGeneratorTest, StreamsContinueAcrossCalls) {
+    ParallelRandomGenerator whole{99, 4};
+    ParallelRandomGenerator parts{99, 2};
+    const auto expected = whole.GenIntegralVector(3 * kMinChunk, 0, 1'000'000);
+    auto values = parts.GenIntegralVector(kMinChunk + 5, 0, 1'000'000);
+    const auto rest = parts.GenIntegralVector(2 * kMinChunk - 5, 0, 1'000'000);
+    values.insert(values.end(), rest.begin(), rest.end());
+    EXPECT_EQ(values, expected);
+}
+}  // namespace
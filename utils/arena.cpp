@@ -0,0 +1,51 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace outfit::utils {
+Arena::Arena(std::size_t block_size) : block_size_(block_size) {
+    AddBlock(0, block_size_);
+}
+
+char* Arena::Reserve(std::size_t size) {
+    Block* block = &blocks_[current_];
+    if (block->capacity - block->used < size) {
+        // Reuse the next block when it is big enough, otherwise put a new one in its place;
+        // blocks are only ever filled in order.
+        if (current_ + 1 == blocks_.size() || blocks_[current_ + 1].capacity < size) {
+            AddBlock(current_ + 1, std::max(block_size_, size));
+        }
+        block = &blocks_[++current_];
+    }
+    return block->data.get() + block->used;
+}
+
+void Arena::Commit(const char* end) {
+    Block& block = blocks_[current_];
+    const auto used = static_cast<std::size_t>(end - block.data.get());
+    size_ += used - block.used;
+    block.used = used;
+}
+
+std::size_t Arena::Size() const {
+    return size_;
+}
+
+void Arena::Reset() {
+    for (std::size_t i = 0; i <= current_; ++i) {
+        blocks_[i].used = 0;
+    }
+    current_ = 0;
+    size_ = 0;
+}
+
+void Arena::AddBlock(std::size_t at, std::size_t capacity) {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,cppcoreguidelines-owning-memory)
+    std::unique_ptr<char[]> data(new char[capacity]);
+    blocks_.insert(
+        std::next(blocks_.begin(), static_cast<std::ptrdiff_t>(at)),
+        Block{std::move(data), capacity, 0});
+}
+}  // namespace outfit::utils
@@ -0,0 +1,64 @@
+#ifndef CREATIVE_ARENA_H
+#define CREATIVE_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace outfit::utils {
+// Bump allocator for output bytes. Reset() keeps every block, so once the arena has grown
+// to the size of one batch, formatting further batches allocates nothing.
+class Arena {
+   public:
+    explicit Arena(std::size_t block_size);
+
+    // Returns room for at least size contiguous bytes after the data committed so far.
+    char* Reserve(std::size_t size);
+
+    // Marks the bytes of the last reservation up to end as used.
+    void Commit(const char* end);
+
+    void Append(char c) {
+        Block& block = blocks_[current_];
+        if (block.used == block.capacity) {
+            Reserve(1);
+            Append(c);
+            return;
+        }
+        block.data[block.used++] = c;
+        ++size_;
+    }
+
+    [[nodiscard]] std::size_t Size() const;
+
+    // Calls fn(data, size) for every used block in order and stops at the first false.
+    template <class Fn>
+    bool ForEachBlock(Fn&& fn) const {
+        for (std::size_t i = 0; i <= current_; ++i) {
+            const Block& block = blocks_[i];
+            if (block.used > 0 && !fn(block.data.get(), block.used)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Reset();
+
+   private:
+    struct Block {
+        std::unique_ptr<char[]> data;  // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        std::size_t capacity;
+        std::size_t used;
+    };
+
+    void AddBlock(std::size_t at, std::size_t capacity);
+
+    std::size_t block_size_;
+    std::vector<Block> blocks_;
+    std::size_t current_ = 0;
+    std::size_t size_ = 0;
+};
+}  // namespace outfit::utils
+
+#endif  // CREATIVE_ARENA_H
@@ -0,0 +1,443 @@
+#include "columnar.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+namespace outfit::utils::columnar {
+namespace {
+static_assert(std::endian::native == std::endian::little, "the format is little-endian");
+
+constexpr std::string_view kMagic = "OFCOL001";
+constexpr std::size_t kAlignment = 8;
+// Dictionary codes are u16, and a dictionary only pays off when values repeat.
+constexpr std::size_t kMaxDictEntries = 65'535;
+constexpr std::size_t kMinRowsPerEntry = 4;
+
+constexpr std::size_t AlignUp(std::size_t size) {
+    return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+constexpr std::size_t BitmapSize(uint32_t rows) {
+    return AlignUp((static_cast<std::size_t>(rows) + 7) / 8);
+}
+
+template <class T>
+void Put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <class T>
+T Load(const char* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// Bounds-checked cursor over the footer.
+class Cursor {
+   public:
+    explicit Cursor(std::string_view data) : data_(data) {
+    }
+
+    template <class T>
+    bool Read(T& value) {
+        if (data_.size() < sizeof(T)) {
+            return false;
+        }
+        value = Load<T>(data_.data());
+        data_.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    [[nodiscard]] std::size_t Remaining() const {
+        return data_.size();
+    }
+
+    bool Read(std::string& value, std::size_t size) {
+        if (data_.size() < size) {
+            return false;
+        }
+        value.assign(data_.substr(0, size));
+        data_.remove_prefix(size);
+        return true;
+    }
+
+   private:
+    std::string_view data_;
+};
+
+bool Matches(ColumnType type, Encoding encoding) {
+    switch (type) {
+        case ColumnType::kInt64:
+            return encoding == Encoding::kInt64;
+        case ColumnType::kDouble:
+            return encoding == Encoding::kDouble;
+        case ColumnType::kString:
+            return encoding == Encoding::kPlain || encoding == Encoding::kDict;
+    }
+    return false;
+}
+
+// Whether a block of `size` bytes at `block` has exactly the layout the writer produces for
+// its encoding and row count. All sums stay far below 2^64: rows and entries are u32.
+bool LayoutFits(Encoding encoding, uint32_t rows, const char* block, uint64_t size) {
+    const uint64_t bitmap = BitmapSize(rows);
+    switch (encoding) {
+        case Encoding::kInt64:
+        case Encoding::kDouble:
+            return size == bitmap + uint64_t{rows} * sizeof(int64_t);
+        case Encoding::kPlain: {
+            const uint64_t header = bitmap + (uint64_t{rows} + 1) * sizeof(uint32_t);
+            return size >= header &&
+                   Load<uint32_t>(block + bitmap + uint64_t{rows} * sizeof(uint32_t)) ==
+                       size - header;
+        }
+        case Encoding::kDict: {
+            if (size < bitmap + sizeof(uint32_t)) {
+                return false;
+            }
+            const auto entries = Load<uint32_t>(block + bitmap);
+            const uint64_t offsets = bitmap + sizeof(uint32_t);
+            const uint64_t bytes = offsets + (uint64_t{entries} + 1) * sizeof(uint32_t);
+            if (entries > kMaxDictEntries || (entries == 0 && rows > 0) || size < bytes) {
+                return false;
+            }
+            const auto entry_bytes =
+                Load<uint32_t>(block + offsets + uint64_t{entries} * sizeof(uint32_t));
+            return size == AlignUp(bytes + entry_bytes) + uint64_t{rows} * sizeof(uint16_t);
+        }
+    }
+    return false;
+}
+}  // namespace
+
+Writer::Writer(std::vector<ColumnSchema> schema, Sink sink, uint32_t rows_per_group)
+    : schema_(std::move(schema))
+    , sink_(std::move(sink))
+    , rows_per_group_(rows_per_group)
+    , columns_(schema_.size()) {
+    for (ColumnBuffer& column : columns_) {
+        column.offsets.push_back(0);
+    }
+    Write(kMagic.data(), kMagic.size());
+}
+
+Writer::ColumnBuffer& Writer::Current() {
+    return columns_[column_];
+}
+
+void Writer::MarkNull(bool null) {
+    std::vector<uint8_t>& nulls = Current().nulls;
+    const uint32_t byte = group_rows_ / 8;
+    if (nulls.size() <= byte) {
+        nulls.resize(byte + 1, 0);
+    }
+    if (null) {
+        nulls[byte] |= static_cast<uint8_t>(1U << (group_rows_ % 8));
+    }
+}
+
+void Writer::AppendNull() {
+    MarkNull(true);
+    ColumnBuffer& column = Current();
+    switch (schema_[column_].type) {
+        case ColumnType::kInt64:
+            column.ints.push_back(0);
+            break;
+        case ColumnType::kDouble:
+            column.doubles.push_back(0);
+            break;
+        case ColumnType::kString:
+            column.offsets.push_back(static_cast<uint32_t>(column.bytes.size()));
+            break;
+    }
+    ++column_;
+}
+
+void Writer::AppendInt64(int64_t value) {
+    MarkNull(false);
+    Current().ints.push_back(value);
+    ++column_;
+}
+
+void Writer::AppendDouble(double value) {
+    MarkNull(false);
+    Current().doubles.push_back(value);
+    ++column_;
+}
+
+void Writer::AppendString(std::string_view value) {
+    MarkNull(false);
+    ColumnBuffer& column = Current();
+    column.bytes.append(value);
+    column.offsets.push_back(static_cast<uint32_t>(column.bytes.size()));
+    ++column_;
+}
+
+bool Writer::EndRow() {
+    column_ = 0;
+    ++rows_;
+    if (++group_rows_ == rows_per_group_) {
+        return FlushGroup();
+    }
+    return ok_;
+}
+
+bool Writer::Finish() {
+    if (!FlushGroup() || !Pad()) {
+        return false;
+    }
+    std::string footer;
+    Put(footer, static_cast<uint32_t>(schema_.size()));
+    for (const ColumnSchema& column : schema_) {
+        Put(footer, column.type);
+        Put(footer, static_cast<uint32_t>(column.name.size()));
+        footer.append(column.name);
+    }
+    Put(footer, static_cast<uint32_t>(group_sizes_.size()));
+    for (std::size_t group = 0; group < group_sizes_.size(); ++group) {
+        Put(footer, group_sizes_[group]);
+        for (std::size_t i = 0; i < schema_.size(); ++i) {
+            const BlockInfo& block = blocks_[group * schema_.size() + i];
+            Put(footer, block.encoding);
+            Put(footer, block.offset);
+            Put(footer, block.size);
+        }
+    }
+    Put(footer, static_cast<uint64_t>(footer.size()));
+    footer.append(kMagic);
+    return Write(footer.data(), footer.size());
+}
+
+uint64_t Writer::RowsWritten() const {
+    return rows_;
+}
+
+uint64_t Writer::BytesWritten() const {
+    return offset_;
+}
+
+bool Writer::FlushGroup() {
+    if (group_rows_ == 0) {
+        return ok_;
+    }
+    for (std::size_t i = 0; i < columns_.size(); ++i) {
+        ColumnBuffer& column = columns_[i];
+        BlockInfo info{};
+        if (!WriteBlock(column, schema_[i].type, info)) {
+            return false;
+        }
+        blocks_.push_back(info);
+        column.nulls.clear();
+        column.ints.clear();
+        column.doubles.clear();
+        column.offsets.resize(1);
+        column.bytes.clear();
+    }
+    group_sizes_.push_back(group_rows_);
+    group_rows_ = 0;
+    return ok_;
+}
+
+bool Writer::WriteBlock(const ColumnBuffer& column, ColumnType type, BlockInfo& info) {
+    if (!Pad()) {
+        return false;
+    }
+    info.offset = offset_;
+    std::vector<uint8_t> nulls = column.nulls;
+    nulls.resize(BitmapSize(group_rows_), 0);
+    Write(nulls.data(), nulls.size());
+    switch (type) {
+        case ColumnType::kInt64:
+            info.encoding = Encoding::kInt64;
+            Write(column.ints.data(), column.ints.size() * sizeof(int64_t));
+            break;
+        case ColumnType::kDouble:
+            info.encoding = Encoding::kDouble;
+            Write(column.doubles.data(), column.doubles.size() * sizeof(double));
+            break;
+        case ColumnType::kString:
+            if (WriteDictBlock(column, info)) {
+                break;
+            }
+            info.encoding = Encoding::kPlain;
+            Write(column.offsets.data(), column.offsets.size() * sizeof(uint32_t));
+            Write(column.bytes.data(), column.bytes.size());
+            break;
+    }
+    info.size = offset_ - info.offset;
+    return ok_;
+}
+
+// Writes the string column as a dictionary block if it has few enough distinct values;
+// returns false, having written nothing, otherwise.
+bool Writer::WriteDictBlock(const ColumnBuffer& column, BlockInfo& info) {
+    dictionary_.clear();
+    codes_.clear();
+    const std::size_t max_entries = std::min(kMaxDictEntries, group_rows_ / kMinRowsPerEntry);
+    std::string entries;
+    std::vector<uint32_t> offsets{0};
+    for (uint32_t row = 0; row < group_rows_; ++row) {
+        const std::string_view value = std::string_view{column.bytes}.substr(
+            column.offsets[row], column.offsets[row + 1] - column.offsets[row]);
+        auto [it, inserted] =
+            dictionary_.try_emplace(value, static_cast<uint16_t>(dictionary_.size()));
+        if (inserted) {
+            if (dictionary_.size() > max_entries) {
+                return false;
+            }
+            entries.append(value);
+            offsets.push_back(static_cast<uint32_t>(entries.size()));
+        }
+        codes_.push_back(it->second);
+    }
+    info.encoding = Encoding::kDict;
+    const auto count = static_cast<uint32_t>(dictionary_.size());
+    Write(&count, sizeof(count));
+    Write(offsets.data(), offsets.size() * sizeof(uint32_t));
+    Write(entries.data(), entries.size());
+    Pad();
+    Write(codes_.data(), codes_.size() * sizeof(uint16_t));
+    return true;
+}
+
+bool Writer::Write(const void* data, std::size_t size) {
+    if (ok_ && size > 0) {
+        ok_ = sink_(static_cast<const char*>(data), size);
+        offset_ += size;
+    }
+    return ok_;
+}
+
+bool Writer::Pad() {
+    static constexpr char kZeros[kAlignment] = {};
+    return Write(kZeros, AlignUp(offset_) - offset_);
+}
+
+BlockView::BlockView(Encoding encoding, uint32_t rows, const char* data, std::size_t size)
+    : encoding_(encoding)
+    , rows_(rows)
+    , nulls_(data)
+    , payload_(data + BitmapSize(rows))
+    , end_(data + size) {
+}
+
+bool BlockView::IsNull(uint32_t row) const {
+    return ((static_cast<uint8_t>(nulls_[row / 8]) >> (row % 8)) & 1U) != 0;
+}
+
+std::span<const int64_t> BlockView::Int64s() const {
+    if (encoding_ != Encoding::kInt64) {
+        return {};
+    }
+    return {reinterpret_cast<const int64_t*>(payload_), rows_};
+}
+
+std::span<const double> BlockView::Doubles() const {
+    if (encoding_ != Encoding::kDouble) {
+        return {};
+    }
+    return {reinterpret_cast<const double*>(payload_), rows_};
+}
+
+// Reader::Open has checked the block's overall layout; the offsets and codes inside it are
+// only checked here, on access, so that opening a mapped file does not touch every page.
+// A corrupt entry reads as an empty string.
+std::string_view BlockView::String(uint32_t row) const {
+    const char* offsets = payload_;
+    const char* bytes = payload_ + (std::size_t{rows_} + 1) * sizeof(uint32_t);
+    std::size_t bytes_size = end_ - bytes;
+    uint32_t index = row;
+    if (encoding_ == Encoding::kDict) {
+        const auto entries = Load<uint32_t>(payload_);
+        offsets = payload_ + sizeof(uint32_t);
+        bytes = offsets + (std::size_t{entries} + 1) * sizeof(uint32_t);
+        bytes_size = Load<uint32_t>(offsets + std::size_t{entries} * sizeof(uint32_t));
+        const char* codes = end_ - std::size_t{rows_} * sizeof(uint16_t);
+        index = Load<uint16_t>(codes + std::size_t{row} * sizeof(uint16_t));
+        if (index >= entries) {
+            return {};
+        }
+    } else if (encoding_ != Encoding::kPlain) {
+        return {};
+    }
+    const auto begin = Load<uint32_t>(offsets + std::size_t{index} * sizeof(uint32_t));
+    const auto end = Load<uint32_t>(offsets + (std::size_t{index} + 1) * sizeof(uint32_t));
+    if (begin > end || end > bytes_size) {
+        return {};
+    }
+    return {bytes + begin, end - begin};
+}
+
+bool Reader::Open(std::string_view data) {
+    constexpr std::size_t kTrailer = sizeof(uint64_t) + kMagic.size();
+    if (data.size() < kMagic.size() + kTrailer || !data.starts_with(kMagic) ||
+        !data.ends_with(kMagic)) {
+        return false;
+    }
+    const auto footer_size = Load<uint64_t>(data.data() + data.size() - kTrailer);
+    if (footer_size > data.size() - kMagic.size() - kTrailer) {
+        return false;
+    }
+    Cursor cursor(data.substr(data.size() - kTrailer - footer_size, footer_size));
+    // Counts are checked against the footer bytes left before anything is allocated for them.
+    constexpr std::size_t kColumnBytes = sizeof(ColumnType) + sizeof(uint32_t);
+    constexpr std::size_t kBlockBytes = sizeof(Encoding) + 2 * sizeof(uint64_t);
+    uint32_t columns = 0;
+    if (!cursor.Read(columns) || columns > cursor.Remaining() / kColumnBytes) {
+        return false;
+    }
+    columns_.assign(columns, {});
+    for (ColumnSchema& column : columns_) {
+        uint32_t name_size = 0;
+        if (!cursor.Read(column.type) || column.type > ColumnType::kString ||
+            !cursor.Read(name_size) || !cursor.Read(column.name, name_size)) {
+            return false;
+        }
+    }
+    uint32_t groups = 0;
+    if (!cursor.Read(groups) ||
+        groups > cursor.Remaining() / (sizeof(uint32_t) + std::size_t{columns} * kBlockBytes)) {
+        return false;
+    }
+    group_rows_.assign(groups, 0);
+    blocks_.clear();
+    for (uint32_t& rows : group_rows_) {
+        if (!cursor.Read(rows)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < columns; ++i) {
+            BlockRef block{};
+            if (!cursor.Read(block.encoding) || !cursor.Read(block.offset) ||
+                !cursor.Read(block.size) || block.encoding > Encoding::kDict ||
+                !Matches(columns_[i].type, block.encoding) || block.offset % kAlignment != 0 ||
+                block.offset > data.size() || block.size > data.size() - block.offset ||
+                !LayoutFits(block.encoding, rows, data.data() + block.offset, block.size)) {
+                return false;
+            }
+            blocks_.push_back(block);
+        }
+    }
+    data_ = data;
+    return true;
+}
+
+const std::vector<ColumnSchema>& Reader::Columns() const {
+    return columns_;
+}
+
+std::size_t Reader::RowGroups() const {
+    return group_rows_.size();
+}
+
+uint32_t Reader::GroupRows(std::size_t group) const {
+    return group_rows_[group];
+}
+
+BlockView Reader::Block(std::size_t group, std::size_t column) const {
+    const BlockRef& block = blocks_[group * columns_.size() + column];
+    return {block.encoding, group_rows_[group], data_.data() + block.offset, block.size};
+}
+}  // namespace outfit::utils::columnar
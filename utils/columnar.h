@@ -0,0 +1,138 @@
+#ifndef CREATIVE_COLUMNAR_H
+#define CREATIVE_COLUMNAR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Columnar binary export format.
+//
+// File:      "OFCOL001" | row group blocks... | footer | footer size (u64) | "OFCOL001"
+// Block:     null bitmap (1 bit per row, rounded up to 8 bytes) followed by the payload:
+//            kInt64  - int64 values[rows]
+//            kDouble - double values[rows]
+//            kPlain  - u32 offsets[rows + 1], string bytes
+//            kDict   - u32 entries, u32 offsets[entries + 1], string bytes (padded to 8),
+//                      u16 codes[rows]
+// Footer:    u32 columns, per column { u8 type, u32 name size, name },
+//            u32 row groups, per group { u32 rows, per column { u8 encoding, u64 offset,
+//            u64 size } }
+// Every block starts at an 8-byte aligned offset, so a memory-mapped file can be read in
+// place. All integers are little-endian.
+namespace outfit::utils::columnar {
+enum class ColumnType : uint8_t { kInt64, kDouble, kString };
+enum class Encoding : uint8_t { kInt64, kDouble, kPlain, kDict };
+
+struct ColumnSchema {
+    std::string name;
+    ColumnType type;
+};
+
+class Writer {
+   public:
+    // Receives consecutive chunks of the file; returning false aborts the export.
+    using Sink = std::function<bool(const char* data, std::size_t size)>;
+
+    Writer(std::vector<ColumnSchema> schema, Sink sink, uint32_t rows_per_group = 65'536);
+
+    // Values of a row are appended column by column, then the row is closed with EndRow().
+    void AppendNull();
+    void AppendInt64(int64_t value);
+    void AppendDouble(double value);
+    void AppendString(std::string_view value);
+    bool EndRow();
+
+    // Writes the last row group and the footer.
+    bool Finish();
+
+    [[nodiscard]] uint64_t RowsWritten() const;
+    [[nodiscard]] uint64_t BytesWritten() const;
+
+   private:
+    struct ColumnBuffer {
+        std::vector<uint8_t> nulls;
+        std::vector<int64_t> ints;
+        std::vector<double> doubles;
+        std::vector<uint32_t> offsets;
+        std::string bytes;
+    };
+
+    struct BlockInfo {
+        Encoding encoding;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    ColumnBuffer& Current();
+    void MarkNull(bool null);
+    bool FlushGroup();
+    bool WriteBlock(const ColumnBuffer& column, ColumnType type, BlockInfo& info);
+    bool WriteDictBlock(const ColumnBuffer& column, BlockInfo& info);
+    bool Write(const void* data, std::size_t size);
+    bool Pad();
+
+    std::vector<ColumnSchema> schema_;
+    Sink sink_;
+    uint32_t rows_per_group_;
+    std::vector<ColumnBuffer> columns_;
+    std::size_t column_ = 0;
+    uint32_t group_rows_ = 0;
+    std::vector<uint32_t> group_sizes_;
+    std::vector<BlockInfo> blocks_;
+    std::unordered_map<std::string_view, uint16_t> dictionary_;
+    std::vector<uint16_t> codes_;
+    uint64_t rows_ = 0;
+    uint64_t offset_ = 0;
+    bool ok_ = true;
+};
+
+// One column of one row group, pointing into the mapped file.
+class BlockView {
+   public:
+    BlockView(Encoding encoding, uint32_t rows, const char* data, std::size_t size);
+
+    [[nodiscard]] bool IsNull(uint32_t row) const;
+    [[nodiscard]] std::span<const int64_t> Int64s() const;
+    [[nodiscard]] std::span<const double> Doubles() const;
+    [[nodiscard]] std::string_view String(uint32_t row) const;
+
+   private:
+    Encoding encoding_;
+    uint32_t rows_;
+    const char* nulls_;
+    const char* payload_;
+    const char* end_;
+};
+
+// Reads the footer of a memory-mapped file; blocks are decoded lazily, column by column.
+class Reader {
+   public:
+    // Returns false if data is not a complete columnar file, or if any block does not have
+    // the size its encoding and row count call for.
+    bool Open(std::string_view data);
+
+    [[nodiscard]] const std::vector<ColumnSchema>& Columns() const;
+    [[nodiscard]] std::size_t RowGroups() const;
+    [[nodiscard]] uint32_t GroupRows(std::size_t group) const;
+    [[nodiscard]] BlockView Block(std::size_t group, std::size_t column) const;
+
+   private:
+    struct BlockRef {
+        Encoding encoding;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    std::string_view data_;
+    std::vector<ColumnSchema> columns_;
+    std::vector<uint32_t> group_rows_;
+    std::vector<BlockRef> blocks_;
+};
+}  // namespace outfit::utils::columnar
+
+#endif  // CREATIVE_COLUMNAR_H
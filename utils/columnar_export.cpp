@@ -0,0 +1,118 @@
+#include "columnar_export.h"
+
+#include "columnar.h"
+
+#include <QFile>
+#include <QMetaType>
+#include <QSqlError>
+#include <QSqlField>
+#include <QSqlRecord>
+#include <QStringEncoder>
+#include <QVariant>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace outfit::utils::csv {
+namespace {
+columnar::ColumnType ColumnTypeOf(QMetaType type) {
+    switch (type.id()) {
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::Long:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+            return columnar::ColumnType::kInt64;
+        case QMetaType::Double:
+        case QMetaType::Float:
+            return columnar::ColumnType::kDouble;
+        default:
+            return columnar::ColumnType::kString;
+    }
+}
+}  // namespace
+
+ExportResult SaveColumnar(QSqlQuery& query, QIODevice& device) {
+    query.setForwardOnly(true);
+    if (!query.exec()) {
+        return {ExportStatus::kQueryFailed, query.lastError().text()};
+    }
+    const QSqlRecord record = query.record();
+    std::vector<columnar::ColumnSchema> schema;
+    std::vector<columnar::ColumnType> types;
+    for (int i = 0; i < record.count(); ++i) {
+        types.push_back(ColumnTypeOf(record.field(i).metaType()));
+        schema.push_back({record.fieldName(i).toStdString(), types.back()});
+    }
+    columnar::Writer writer(std::move(schema), [&device](const char* data, std::size_t size) {
+        return device.write(data, static_cast<qint64>(size)) == static_cast<qint64>(size);
+    });
+
+    QStringEncoder encoder(QStringEncoder::Utf8);
+    std::string scratch;
+    bool ok = true;
+    while (ok && query.next()) {
+        for (size_t i = 0; i < types.size(); ++i) {
+            const QVariant value = query.value(static_cast<int>(i));
+            if (value.isNull()) {
+                writer.AppendNull();
+                continue;
+            }
+            // SQLite types are advisory, so a numeric column can hold text; such cells are
+            // written as null rather than as a made-up 0.
+            bool converted = false;
+            switch (types[i]) {
+                case columnar::ColumnType::kInt64: {
+                    const qlonglong number = value.toLongLong(&converted);
+                    if (converted) {
+                        writer.AppendInt64(number);
+                    } else {
+                        writer.AppendNull();
+                    }
+                    break;
+                }
+                case columnar::ColumnType::kDouble: {
+                    const double number = value.toDouble(&converted);
+                    if (converted) {
+                        writer.AppendDouble(number);
+                    } else {
+                        writer.AppendNull();
+                    }
+                    break;
+                }
+                case columnar::ColumnType::kString: {
+                    const QString text = value.toString();
+                    scratch.resize(encoder.requiredSpace(text.size()));
+                    const char* end = encoder.appendToBuffer(scratch.data(), text);
+                    writer.AppendString(
+                        {scratch.data(), static_cast<std::size_t>(end - scratch.data())});
+                    break;
+                }
+            }
+        }
+        ok = writer.EndRow();
+    }
+    ok = ok && writer.Finish();
+    ExportResult result;
+    result.rows = static_cast<qint64>(writer.RowsWritten());
+    result.bytes = static_cast<qint64>(writer.BytesWritten());
+    if (!ok) {
+        result.status = ExportStatus::kWriteFailed;
+        result.error = device.errorString();
+    }
+    return result;
+}
+
+ExportResult SaveColumnar(QSqlQuery& query, const QString& file_name) {
+    QFile file(file_name);
+    if (!file.open(QFile::WriteOnly)) {
+        return {ExportStatus::kOpenFailed, file.errorString()};
+    }
+    return SaveColumnar(query, file);
+}
+}  // namespace outfit::utils::csv
@@ -0,0 +1,19 @@
+#ifndef CREATIVE_COLUMNAR_EXPORT_H
+#define CREATIVE_COLUMNAR_EXPORT_H
+
+#include "csv.h"
+
+#include <QIODevice>
+#include <QSqlQuery>
+#include <QString>
+
+namespace outfit::utils::csv {
+// Exports the query in the columnar binary format described in columnar.h. Column names
+// come from the record; integer and boolean fields become int64 columns, floating-point
+// fields double columns and everything else UTF-8 string columns. Cells of a numeric column
+// that do not convert to its type are written as null.
+ExportResult SaveColumnar(QSqlQuery& query, QIODevice& device);
+ExportResult SaveColumnar(QSqlQuery& query, const QString& file_name);
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_COLUMNAR_EXPORT_H
@@ -0,0 +1,48 @@
+#include "columnar_export.h"
+
+#include "columnar.h"
+#include "test_database.h"
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QSqlQuery>
+#include <QStringLiteral>
+
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::csv {
+namespace {
+// SQLite keeps text stored in a numeric column as text; it must not turn into 0.
+TEST(ColumnarExportTest, MismatchedNumbersBecomeNull) {
+    TestDatabase db;
+    db.Exec("CREATE TABLE numbers (id INTEGER, price REAL)");
+    db.Exec("INSERT INTO numbers VALUES (1, 2.5), ('x', 'y'), (0, NULL)");
+    QSqlQuery query(db.Db());
+    query.prepare(QStringLiteral("SELECT id, price FROM numbers ORDER BY rowid"));
+    QBuffer buffer;
+    buffer.open(QBuffer::WriteOnly);
+    const ExportResult result = SaveColumnar(query, buffer);
+    ASSERT_TRUE(result) << result.error.toStdString();
+    EXPECT_EQ(result.rows, 3);
+
+    const QByteArray& data = buffer.data();
+    columnar::Reader reader;
+    ASSERT_TRUE(reader.Open(std::string_view{data.constData(), static_cast<size_t>(data.size())}));
+    ASSERT_EQ(reader.RowGroups(), 1U);
+    ASSERT_EQ(reader.Columns()[0].type, columnar::ColumnType::kInt64);
+    ASSERT_EQ(reader.Columns()[1].type, columnar::ColumnType::kDouble);
+    const columnar::BlockView ids = reader.Block(0, 0);
+    const columnar::BlockView prices = reader.Block(0, 1);
+    EXPECT_FALSE(ids.IsNull(0));
+    EXPECT_EQ(ids.Int64s()[0], 1);
+    EXPECT_TRUE(ids.IsNull(1));
+    EXPECT_FALSE(ids.IsNull(2));
+    EXPECT_EQ(ids.Int64s()[2], 0);
+    EXPECT_EQ(prices.Doubles()[0], 2.5);
+    EXPECT_TRUE(prices.IsNull(1));
+    EXPECT_TRUE(prices.IsNull(2));
+}
+}  // namespace
+}  // namespace outfit::utils::csv
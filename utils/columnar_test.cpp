@@ -0,0 +1,177 @@
+#include "columnar.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::columnar {
+namespace {
+// Two row groups: 8 + 2 rows of (id, price, name, city). "name" is unique per row and stored
+// plain; "city" repeats and is dictionary-encoded in the first group, which has enough rows.
+std::string WriteSample() {
+    std::string file;
+    Writer writer(
+        {{"id", ColumnType::kInt64},
+         {"price", ColumnType::kDouble},
+         {"name", ColumnType::kString},
+         {"city", ColumnType::kString}},
+        [&file](const char* data, std::size_t size) {
+            file.append(data, size);
+            return true;
+        },
+        8);
+    for (int64_t i = 0; i < 10; ++i) {
+        writer.AppendInt64(i * 10);
+        if (i % 3 == 1) {
+            writer.AppendNull();
+        } else {
+            writer.AppendDouble(static_cast<double>(i) + 0.5);
+        }
+        writer.AppendString("name" + std::to_string(i));
+        writer.AppendString(i % 2 == 0 ? "Minsk" : "Brest");
+        EXPECT_TRUE(writer.EndRow());
+    }
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_EQ(writer.RowsWritten(), 10U);
+    EXPECT_EQ(writer.BytesWritten(), file.size());
+    return file;
+}
+
+// Offset of the footer entry { u8 encoding, u64 offset, u64 size } of a block.
+std::size_t BlockEntry(const std::string& file, std::size_t group, std::size_t column) {
+    uint64_t footer_size = 0;
+    std::memcpy(&footer_size, file.data() + file.size() - 16, sizeof(footer_size));
+    std::size_t pos = file.size() - 16 - footer_size;
+    uint32_t columns = 0;
+    std::memcpy(&columns, file.data() + pos, sizeof(columns));
+    pos += sizeof(columns);
+    for (uint32_t i = 0; i < columns; ++i) {
+        uint32_t name_size = 0;
+        std::memcpy(&name_size, file.data() + pos + 1, sizeof(name_size));
+        pos += 1 + sizeof(name_size) + name_size;
+    }
+    pos += sizeof(uint32_t);
+    constexpr std::size_t kBlock = 1 + 2 * sizeof(uint64_t);
+    return pos + group * (sizeof(uint32_t) + columns * kBlock) + sizeof(uint32_t) +
+           column * kBlock;
+}
+
+template <class T>
+void Patch(std::string& file, std::size_t pos, T value) {
+    std::memcpy(file.data() + pos, &value, sizeof(value));
+}
+
+TEST(ColumnarTest, RoundTrip) {
+    const std::string file = WriteSample();
+    Reader reader;
+    ASSERT_TRUE(reader.Open(file));
+    ASSERT_EQ(reader.Columns().size(), 4U);
+    EXPECT_EQ(reader.Columns()[2].name, "name");
+    EXPECT_EQ(reader.Columns()[3].type, ColumnType::kString);
+    ASSERT_EQ(reader.RowGroups(), 2U);
+
+    int64_t row = 0;
+    for (std::size_t group = 0; group < reader.RowGroups(); ++group) {
+        const uint32_t rows = reader.GroupRows(group);
+        const BlockView ids = reader.Block(group, 0);
+        const BlockView prices = reader.Block(group, 1);
+        const BlockView names = reader.Block(group, 2);
+        const BlockView cities = reader.Block(group, 3);
+        ASSERT_EQ(ids.Int64s().size(), rows);
+        ASSERT_EQ(prices.Doubles().size(), rows);
+        EXPECT_TRUE(ids.Doubles().empty());
+        for (uint32_t i = 0; i < rows; ++i, ++row) {
+            EXPECT_FALSE(ids.IsNull(i));
+            EXPECT_EQ(ids.Int64s()[i], row * 10);
+            EXPECT_EQ(prices.IsNull(i), row % 3 == 1);
+            if (!prices.IsNull(i)) {
+                EXPECT_EQ(prices.Doubles()[i], static_cast<double>(row) + 0.5);
+            }
+            EXPECT_EQ(names.String(i), "name" + std::to_string(row));
+            EXPECT_EQ(cities.String(i), row % 2 == 0 ? "Minsk" : "Brest");
+        }
+    }
+    EXPECT_EQ(row, 10);
+}
+
+TEST(ColumnarTest, RejectsTruncatedFile) {
+    const std::string file = WriteSample();
+    Reader reader;
+    for (std::size_t size = 0; size < file.size(); ++size) {
+        EXPECT_FALSE(reader.Open(std::string_view{file}.substr(0, size))) << size;
+    }
+}
+
+TEST(ColumnarTest, RejectsBlockOutsideFile) {
+    std::string file = WriteSample();
+    const std::size_t entry = BlockEntry(file, 1, 0);
+    Reader reader;
+
+    std::string overflow = file;
+    Patch<uint64_t>(overflow, entry + 1, 8);
+    Patch<uint64_t>(overflow, entry + 9, ~uint64_t{0});
+    EXPECT_FALSE(reader.Open(overflow));
+
+    std::string past_end = file;
+    Patch<uint64_t>(past_end, entry + 1, file.size() + 8);
+    Patch<uint64_t>(past_end, entry + 9, 0);
+    EXPECT_FALSE(reader.Open(past_end));
+}
+
+TEST(ColumnarTest, RejectsWrongBlockSize) {
+    std::string file = WriteSample();
+    Reader reader;
+
+    std::string short_block = file;
+    uint64_t size = 0;
+    std::memcpy(&size, file.data() + BlockEntry(file, 0, 1) + 9, sizeof(size));
+    Patch<uint64_t>(short_block, BlockEntry(file, 0, 1) + 9, size - 8);
+    EXPECT_FALSE(reader.Open(short_block));
+
+    // A huge row count with the original, much smaller blocks.
+    std::string rows = file;
+    Patch<uint32_t>(rows, BlockEntry(file, 0, 0) - sizeof(uint32_t), 1U << 30);
+    EXPECT_FALSE(reader.Open(rows));
+}
+
+TEST(ColumnarTest, RejectsBadEnums) {
+    std::string file = WriteSample();
+    Reader reader;
+
+    std::string encoding = file;
+    Patch<uint8_t>(encoding, BlockEntry(file, 0, 2), 7);
+    EXPECT_FALSE(reader.Open(encoding));
+
+    // A string column claiming int64 values.
+    std::string mismatch = file;
+    Patch(mismatch, BlockEntry(file, 0, 2), Encoding::kInt64);
+    EXPECT_FALSE(reader.Open(mismatch));
+
+    std::string type = file;
+    uint64_t footer_size = 0;
+    std::memcpy(&footer_size, file.data() + file.size() - 16, sizeof(footer_size));
+    Patch<uint8_t>(type, file.size() - 16 - footer_size + sizeof(uint32_t), 9);
+    EXPECT_FALSE(reader.Open(type));
+}
+
+TEST(ColumnarTest, CorruptDictCodeReadsEmpty) {
+    std::string file = WriteSample();
+    const std::size_t entry = BlockEntry(file, 0, 3);
+    ASSERT_EQ(static_cast<Encoding>(file[entry]), Encoding::kDict);
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    std::memcpy(&offset, file.data() + entry + 1, sizeof(offset));
+    std::memcpy(&size, file.data() + entry + 9, sizeof(size));
+    // The first of the group's eight u16 codes, which end the block.
+    Patch<uint16_t>(file, offset + size - 8 * sizeof(uint16_t), 2);
+
+    Reader reader;
+    ASSERT_TRUE(reader.Open(file));
+    const BlockView cities = reader.Block(0, 3);
+    EXPECT_EQ(cities.String(0), "");
+    EXPECT_EQ(cities.String(1), "Brest");
+}
+}  // namespace
+}  // namespace outfit::utils::columnar
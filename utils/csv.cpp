@@ -4,54 +4,156 @@
 
 #include "csv.h"
 
+#include "csv_compress.h"
+#include "csv_schema.h"
+#include "csv_writer.h"
+#include "escape.h"
+
 #include <QFile>
 #include <QFileDialog>
 #include <QLatin1Char>
 #include <QMessageBox>
 #include <QSqlQuery>
-#include <QSqlRecord>
 #include <QString>
 #include <QStringLiteral>
-#include <QTextStream>
-#include <QtCore/qstringconverter_base.h>
 
-QString outfit::utils::csv::EscapeCSV(QString unexc) {
-    if (!unexc.contains(QLatin1Char(','))) {
+#include <cstddef>
+#include <optional>
+
+QString outfit::utils::csv::EscapeCSV(const QString& unexc) {
+    const auto size = static_cast<std::size_t>(unexc.size());
+    if (FindSpecial(reinterpret_cast<const char16_t*>(unexc.utf16()), size) == size) {
         return unexc;
     }
-    return '\"' + unexc.replace(QLatin1Char('\"'), QStringLiteral("\"\"")) + '\"';
+    return '\"' + QString(unexc).replace(QLatin1Char('\"'), QStringLiteral("\"\"")) + '\"';
+}
+
+namespace {
+// A missing header means the writer takes it from the query's record.
+using Header = std::optional<QString>;
+
+template <class D>
+outfit::utils::csv::ExportResult Save(const Header& header, QSqlQuery& query, QIODevice& device) {
+    outfit::utils::csv::BasicWriter<D> writer(device, {.header_from_record = !header});
+    if (header) {
+        writer.WriteHeader(*header);
+    }
+    return writer.WriteQuery(query);
+}
+
+template <class D>
+outfit::utils::csv::ExportResult Save(
+    const Header& header, QSqlQuery& query, QIODevice& device, bool crlf) {
+    return crlf ? Save<outfit::utils::csv::CrLf<D>>(header, query, device)
+                : Save<D>(header, query, device);
+}
+
+outfit::utils::csv::ExportResult Save(
+    const Header& header, QSqlQuery& query, QIODevice& device,
+    outfit::utils::csv::Format format) {
+    using outfit::utils::csv::Format;
+    switch (format.separator) {
+        case Format::Separator::kTab:
+            return Save<outfit::utils::csv::TabDialect>(header, query, device, format.crlf);
+        case Format::Separator::kSemicolon:
+            return Save<outfit::utils::csv::SemicolonDialect>(header, query, device, format.crlf);
+        case Format::Separator::kPipe:
+            return Save<outfit::utils::csv::PipeDialect>(header, query, device, format.crlf);
+        case Format::Separator::kComma:
+            break;
+    }
+    return Save<outfit::utils::csv::CommaDialect>(header, query, device, format.crlf);
+}
+
+outfit::utils::csv::ExportResult Save(
+    const Header& header, QSqlQuery& query, const QString& file_name,
+    outfit::utils::csv::Compression compression, outfit::utils::csv::Format format) {
+    using outfit::utils::csv::Compression;
+    using outfit::utils::csv::ExportResult;
+    using outfit::utils::csv::ExportStatus;
+    QFile csv_file(file_name);
+    if (compression == Compression::kNone) {
+        // Text mode would turn the CRLF dialect's "\r\n" into "\r\r\n" on Windows.
+        QIODevice::OpenMode mode = QFile::WriteOnly;
+        if (!format.crlf) {
+            mode |= QFile::Text;
+        }
+        if (!csv_file.open(mode)) {
+            return {ExportStatus::kOpenFailed, csv_file.errorString()};
+        }
+        return Save(header, query, csv_file, format);
+    }
+    if (!csv_file.open(QFile::WriteOnly)) {
+        return {ExportStatus::kOpenFailed, csv_file.errorString()};
+    }
+    outfit::utils::csv::CompressedDevice device(csv_file, compression);
+    if (!device.open(QIODevice::WriteOnly)) {
+        return {ExportStatus::kOpenFailed, device.errorString()};
+    }
+    ExportResult result = Save(header, query, device, format);
+    if (!device.Finish() && result) {
+        result.status = ExportStatus::kWriteFailed;
+        result.error = device.errorString();
+    }
+    return result;
+}
+}  // namespace
+
+outfit::utils::csv::ExportResult outfit::utils::csv::SaveQuery(
+    const QString& header, QSqlQuery& query, QIODevice& device, Format format) {
+    return Save(header, query, device, format);
+}
+
+outfit::utils::csv::ExportResult outfit::utils::csv::SaveQuery(
+    QSqlQuery& query, QIODevice& device, Format format) {
+    return Save(std::nullopt, query, device, format);
+}
+
+outfit::utils::csv::Compression outfit::utils::csv::CompressionFromFileName(
+    const QString& file_name) {
+    if (file_name.endsWith(QStringLiteral(".gz"), Qt::CaseInsensitive)) {
+        return Compression::kGzip;
+    }
+    if (file_name.endsWith(QStringLiteral(".zst"), Qt::CaseInsensitive)) {
+        return Compression::kZstd;
+    }
+    return Compression::kNone;
+}
+
+outfit::utils::csv::ExportResult outfit::utils::csv::SaveQuery(
+    const QString& header, QSqlQuery& query, const QString& file_name) {
+    return SaveQuery(header, query, file_name, CompressionFromFileName(file_name));
+}
+
+outfit::utils::csv::ExportResult outfit::utils::csv::SaveQuery(
+    const QString& header, QSqlQuery& query, const QString& file_name, Compression compression,
+    Format format) {
+    return Save(header, query, file_name, compression, format);
+}
+
+outfit::utils::csv::ExportResult outfit::utils::csv::SaveQuery(
+    QSqlQuery& query, const QString& file_name, bool write_schema, Format format) {
+    ExportResult result =
+        Save(std::nullopt, query, file_name, CompressionFromFileName(file_name), format);
+    if (result && write_schema &&
+        !WriteSchema(SchemaFileName(file_name), SchemaFromRecord(query.record(), result.rows))) {
+        result.status = ExportStatus::kWriteFailed;
+        result.error = QStringLiteral("failed to write the schema sidecar");
+    }
+    return result;
 }
 
 void outfit::utils::csv::SaveQuery(const QString& header, QSqlQuery& query) {
     const QString file_name =
-        QFileDialog::getSaveFileName(nullptr, "export.csv", ".", "CSV (*.csv)");
+        QFileDialog::getSaveFileName(
+            nullptr, "export.csv", ".", "CSV (*.csv);;Compressed CSV (*.csv.gz *.csv.zst)");
     if (file_name == "") {
         return;
     }
-    QFile csv_file(file_name);
-    if (!csv_file.open(QFile::WriteOnly | QFile::Text)) {
+    const ExportResult result = SaveQuery(header, query, file_name);
+    if (!result) {
         QMessageBox msg;
-        msg.setText("failed to open file");
+        msg.setText(result.error);
         msg.exec();
-        return;
     }
-    if (!query.exec()) {
-        QMessageBox msg;
-        msg.setText("failed to run query");
-        msg.exec();
-        return;
-    }
-    QTextStream out_stream(&csv_file);
-    out_stream << header << "\n";
-    out_stream.setEncoding(QStringConverter::Utf8);
-    while (query.next()) {
-        const QSqlRecord record = query.record();
-        for (int i = 0, rec_count = record.count(); i < rec_count; ++i) {
-            if (i > 0) {
-                out_stream << ',';
-            }
-            out_stream << utils::csv::EscapeCSV(record.value(i).toString());
-        }
-        out_stream << '\n';
-    }
-}
\ No newline at end of file
+}
@@ -5,12 +5,69 @@
 #ifndef CREATIVE_CSV_H
 #define CREATIVE_CSV_H
 
+#include <QIODevice>
 #include <QSqlQuery>
 #include <QString>
 
 namespace outfit::utils::csv {
-QString EscapeCSV(QString unexc);
+enum class ExportStatus {
+    kOk,
+    kOpenFailed,
+    kQueryFailed,
+    kWriteFailed,
+    kCancelled,
+    kParseFailed,
+};
 
+enum class Compression { kNone, kGzip, kZstd };
+
+// Runtime choice of dialect. The export dispatches once on it to a writer specialized for
+// that delimiter and line ending.
+struct Format {
+    enum class Separator { kComma, kTab, kSemicolon, kPipe };
+
+    Separator separator = Separator::kComma;
+    // RFC 4180 line endings instead of '\n'.
+    bool crlf = false;
+};
+
+// Picks gzip for ".gz" and zstd for ".zst" file names.
+Compression CompressionFromFileName(const QString& file_name);
+
+// Outcome of an export, or of a load back from CSV.
+struct ExportResult {
+    ExportStatus status = ExportStatus::kOk;
+    QString error;
+    qint64 rows = 0;
+    qint64 bytes = 0;
+
+    explicit operator bool() const {
+        return status == ExportStatus::kOk;
+    }
+};
+
+// Quotes fields that contain a comma, a quote or a line break; other fields are returned
+// without a copy.
+QString EscapeCSV(const QString& unexc);
+
+// header is written verbatim as the first line: it must already be separated and escaped
+// for the chosen format, e.g. "id;name" with Separator::kSemicolon. The overloads without a
+// header below build it in the right dialect.
+ExportResult SaveQuery(
+    const QString& header, QSqlQuery& query, QIODevice& device, Format format = {});
+ExportResult SaveQuery(const QString& header, QSqlQuery& query, const QString& file_name);
+ExportResult SaveQuery(
+    const QString& header, QSqlQuery& query, const QString& file_name, Compression compression,
+    Format format = {});
+
+// Same as above with the header row built from the query's field names, so it cannot drift
+// from the columns. With write_schema the file is followed by a SchemaFileName() sidecar
+// holding the column types and the row count.
+ExportResult SaveQuery(QSqlQuery& query, QIODevice& device, Format format = {});
+ExportResult SaveQuery(
+    QSqlQuery& query, const QString& file_name, bool write_schema, Format format = {});
+
+// Asks for the destination with a file dialog and reports failures in a message box.
 void SaveQuery(const QString& header, QSqlQuery& query);
 }  // namespace outfit::utils::csv
 
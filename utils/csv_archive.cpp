@@ -0,0 +1,250 @@
+#include "csv_archive.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QIODevice>
+#include <QSaveFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringLiteral>
+#include <QThread>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace outfit::utils::csv {
+namespace {
+constexpr qint64 kTarBlock = 512;
+constexpr qint64 kCopyBlock = qint64{1} << 20;
+// Largest size the 11 octal digits of a ustar header can hold.
+constexpr qint64 kMaxOctalSize = (qint64{1} << 33) - 1;
+
+struct Member {
+    QString chunk_name;
+    ExportResult result;
+};
+
+// Finished entries, handed from the workers to the thread that writes the archive.
+class Completions {
+   public:
+    void Push(int index) {
+        {
+            const std::lock_guard lock(mutex_);
+            done_.push_back(index);
+        }
+        ready_.notify_one();
+    }
+
+    int Pop() {
+        std::unique_lock lock(mutex_);
+        ready_.wait(lock, [this] { return !done_.empty(); });
+        const int index = done_.front();
+        done_.pop_front();
+        return index;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<int> done_;
+};
+
+ExportResult ExportEntry(
+    const ArchiveExportTask& task, const ArchiveEntry& entry, const Member& member,
+    QSqlDatabase& db) {
+    // Archive members are stored byte for byte, so the chunk is not opened in text mode.
+    QFile chunk(member.chunk_name);
+    if (!chunk.open(QFile::WriteOnly)) {
+        return {ExportStatus::kOpenFailed, chunk.errorString()};
+    }
+    QSqlQuery query(db);
+    if (!query.prepare(entry.sql)) {
+        return {ExportStatus::kQueryFailed, query.lastError().text()};
+    }
+    for (const QVariant& value : entry.bind_values) {
+        query.addBindValue(value);
+    }
+    return SaveQuery(entry.header, query, chunk, task.format);
+}
+
+// Takes entries off the shared counter until none are left, so a worker that drew a short
+// query moves on to the next one instead of idling.
+void RunWorker(
+    const ArchiveExportTask& task, std::vector<Member>& members, std::atomic<int>& next,
+    std::atomic<bool>& failed, Completions& completions, int worker) {
+    const QString connection = QStringLiteral("csv_archive_%1_%2")
+                                   .arg(reinterpret_cast<quintptr>(&task), 0, 16)
+                                   .arg(worker);
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(task.connection_name, connection);
+        const bool opened = db.open();
+        for (int index = next++; index < static_cast<int>(members.size()); index = next++) {
+            Member& member = members[index];
+            if (!opened) {
+                member.result = {ExportStatus::kOpenFailed, db.lastError().text()};
+            } else if (failed) {
+                member.result = {ExportStatus::kCancelled, QStringLiteral("export cancelled")};
+            } else {
+                member.result = ExportEntry(task, task.entries[index], member, db);
+            }
+            if (!member.result) {
+                failed = true;
+            }
+            completions.Push(index);
+        }
+    }
+    QSqlDatabase::removeDatabase(connection);
+}
+
+void WriteOctal(char* field, std::size_t width, qint64 value) {
+    field[width - 1] = '\0';
+    for (std::size_t i = width - 1; i > 0; --i) {
+        field[i - 1] = static_cast<char>('0' + (value & 7));
+        value >>= 3;
+    }
+}
+
+// Sizes past the octal range use the base-256 form understood by GNU and BSD tar.
+void WriteSize(char* field, qint64 size) {
+    if (size <= kMaxOctalSize) {
+        WriteOctal(field, 12, size);
+        return;
+    }
+    field[0] = static_cast<char>(0x80);
+    for (int i = 11; i > 0; --i) {
+        field[i] = static_cast<char>(size & 0xff);
+        size >>= 8;
+    }
+}
+
+std::array<char, kTarBlock> TarHeader(const QByteArray& name, qint64 size) {
+    std::array<char, kTarBlock> header{};
+    std::memcpy(header.data(), name.constData(), static_cast<std::size_t>(name.size()));
+    WriteOctal(header.data() + 100, 8, 0644);
+    WriteOctal(header.data() + 108, 8, 0);
+    WriteOctal(header.data() + 116, 8, 0);
+    WriteSize(header.data() + 124, size);
+    WriteOctal(header.data() + 136, 12, QDateTime::currentSecsSinceEpoch());
+    header[156] = '0';
+    std::memcpy(header.data() + 257, "ustar", 6);
+    std::memcpy(header.data() + 263, "00", 2);
+    // The checksum is computed with its own field filled with spaces.
+    std::memset(header.data() + 148, ' ', 8);
+    qint64 checksum = 0;
+    for (const char c : header) {
+        checksum += static_cast<unsigned char>(c);
+    }
+    WriteOctal(header.data() + 148, 7, checksum);
+    return header;
+}
+
+bool AppendMember(QIODevice& archive, const QByteArray& name, const QString& chunk_name) {
+    QFile chunk(chunk_name);
+    if (!chunk.open(QFile::ReadOnly)) {
+        return false;
+    }
+    const qint64 size = chunk.size();
+    const auto header = TarHeader(name, size);
+    if (archive.write(header.data(), kTarBlock) != kTarBlock) {
+        return false;
+    }
+    for (qint64 copied = 0; copied < size;) {
+        const QByteArray block = chunk.read(std::min(kCopyBlock, size - copied));
+        if (block.isEmpty() || archive.write(block) != block.size()) {
+            return false;
+        }
+        copied += block.size();
+    }
+    const std::array<char, kTarBlock> padding{};
+    const qint64 tail = (kTarBlock - size % kTarBlock) % kTarBlock;
+    return archive.write(padding.data(), tail) == tail;
+}
+}  // namespace
+
+ExportResult SaveArchive(const ArchiveExportTask& task) {
+    const int count = static_cast<int>(task.entries.size());
+    std::vector<QByteArray> names;
+    for (const ArchiveEntry& entry : task.entries) {
+        names.push_back(entry.name.toUtf8());
+        if (names.back().isEmpty() || names.back().size() > 100) {
+            return {ExportStatus::kOpenFailed,
+                    QStringLiteral("invalid archive member name: %1").arg(entry.name)};
+        }
+    }
+    // QSaveFile only replaces task.file_name on commit(), so a failed export leaves any
+    // previous archive in place.
+    QSaveFile archive(task.file_name);
+    if (!archive.open(QFile::WriteOnly)) {
+        return {ExportStatus::kOpenFailed, archive.errorString()};
+    }
+
+    std::vector<Member> members(count);
+    for (int i = 0; i < count; ++i) {
+        members[i].chunk_name = QStringLiteral("%1.entry%2").arg(task.file_name).arg(i);
+    }
+    std::atomic<int> next = 0;
+    std::atomic<bool> failed = false;
+    Completions completions;
+    const int threads = std::clamp(
+        task.threads > 0 ? task.threads : QThread::idealThreadCount(), 1, std::max(count, 1));
+    std::vector<std::unique_ptr<QThread>> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(QThread::create([&, i] {
+            RunWorker(task, members, next, failed, completions, i);
+        }));
+        workers.back()->start();
+    }
+
+    // Members go into the archive in entry order: a chunk that finishes early stays on disk
+    // until every entry before it has been appended.
+    ExportResult result;
+    std::vector<bool> done(count);
+    int appended = 0;
+    for (int finished = 0; finished < count; ++finished) {
+        done[completions.Pop()] = true;
+        for (; result && appended < count && done[appended]; ++appended) {
+            const Member& member = members[appended];
+            if (!member.result) {
+                result = member.result;
+                failed = true;
+            } else if (!AppendMember(archive, names[appended], member.chunk_name)) {
+                result = {ExportStatus::kWriteFailed, archive.errorString()};
+                failed = true;
+            } else {
+                result.rows += member.result.rows;
+            }
+            QFile::remove(member.chunk_name);
+        }
+    }
+    for (const auto& worker : workers) {
+        worker->wait();
+    }
+    for (const Member& member : members) {
+        QFile::remove(member.chunk_name);
+    }
+
+    // Two zero blocks mark the end of the archive.
+    const std::array<char, 2 * kTarBlock> trailer{};
+    if (result && archive.write(trailer.data(), 2 * kTarBlock) != 2 * kTarBlock) {
+        result = {ExportStatus::kWriteFailed, archive.errorString()};
+    }
+    if (!result) {
+        archive.cancelWriting();
+        return result;
+    }
+    result.bytes = archive.size();
+    if (!archive.commit()) {
+        return {ExportStatus::kWriteFailed, archive.errorString(), result.rows};
+    }
+    return result;
+}
+}  // namespace outfit::utils::csv
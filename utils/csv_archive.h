@@ -0,0 +1,36 @@
+#ifndef CREATIVE_CSV_ARCHIVE_H
+#define CREATIVE_CSV_ARCHIVE_H
+
+#include "csv.h"
+
+#include <QList>
+#include <QString>
+#include <QVariantList>
+
+namespace outfit::utils::csv {
+struct ArchiveEntry {
+    // Member name inside the archive, e.g. "orders.csv"; at most 100 bytes of UTF-8.
+    QString name;
+    QString header;
+    QString sql;
+    QVariantList bind_values;
+};
+
+struct ArchiveExportTask {
+    // Connection whose settings every worker clones for its own QSqlDatabase.
+    QString connection_name;
+    QList<ArchiveEntry> entries;
+    // Queries run at the same time; 0 means QThread::idealThreadCount().
+    int threads = 0;
+    Format format;
+    QString file_name;
+};
+
+// Runs the entries' queries concurrently, one connection per worker thread, and packs the
+// CSV files into a single POSIX tar archive, with the members in entry order. The archive
+// replaces file_name only once it is complete, so the export takes about as long as the
+// slowest query and a failed one leaves no partial archive behind.
+ExportResult SaveArchive(const ArchiveExportTask& task);
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_ARCHIVE_H
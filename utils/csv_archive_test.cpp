@@ -0,0 +1,98 @@
+#include "csv_archive.h"
+
+#include "test_database.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringLiteral>
+
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::csv {
+namespace {
+constexpr qsizetype kTarBlock = 512;
+
+// (name, contents) of the members of a ustar archive, in archive order.
+std::vector<std::pair<QByteArray, QByteArray>> ReadTar(const QString& file_name) {
+    QFile file(file_name);
+    EXPECT_TRUE(file.open(QFile::ReadOnly));
+    const QByteArray tar = file.readAll();
+    std::vector<std::pair<QByteArray, QByteArray>> members;
+    for (qsizetype pos = 0; pos + kTarBlock <= tar.size();) {
+        const QByteArray header = tar.mid(pos, kTarBlock);
+        if (header.count('\0') == kTarBlock) {
+            break;
+        }
+        const QByteArray name = header.left(100).left(header.indexOf('\0'));
+        const qsizetype size = header.mid(124, 11).toLongLong(nullptr, 8);
+        members.emplace_back(name, tar.mid(pos + kTarBlock, size));
+        pos += kTarBlock + (size + kTarBlock - 1) / kTarBlock * kTarBlock;
+    }
+    return members;
+}
+
+class ArchiveTest : public testing::Test {
+   protected:
+    ArchiveTest() {
+        task_.connection_name = db_.ConnectionName();
+        task_.file_name = db_.Path(QStringLiteral("export.tar"));
+        task_.threads = 2;
+    }
+
+    TestDatabase db_;
+    ArchiveExportTask task_;
+};
+
+// The first entry is by far the slowest, yet it stays the first member.
+TEST_F(ArchiveTest, MembersInEntryOrder) {
+    task_.entries = {
+        {QStringLiteral("big.csv"), QStringLiteral("n"),
+         QStringLiteral(
+             "WITH RECURSIVE s(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM s WHERE n < ?) "
+             "SELECT n FROM s"),
+         {200'000}},
+        {QStringLiteral("small.csv"), QStringLiteral("x"), QStringLiteral("SELECT 7"), {}},
+        {QStringLiteral("empty.csv"), QStringLiteral("y"), QStringLiteral("SELECT 1 WHERE 0"),
+         {}},
+    };
+    const ExportResult result = SaveArchive(task_);
+    ASSERT_TRUE(result) << result.error.toStdString();
+    EXPECT_EQ(result.rows, 200'001);
+    EXPECT_EQ(result.bytes, QFile(task_.file_name).size());
+
+    const auto members = ReadTar(task_.file_name);
+    ASSERT_EQ(members.size(), 3U);
+    EXPECT_EQ(members[0].first, "big.csv");
+    EXPECT_TRUE(members[0].second.startsWith("n\n1\n2\n3\n"));
+    EXPECT_TRUE(members[0].second.endsWith("\n200000\n"));
+    EXPECT_EQ(members[1], std::pair<QByteArray, QByteArray>("small.csv", "x\n7\n"));
+    EXPECT_EQ(members[2], std::pair<QByteArray, QByteArray>("empty.csv", "y\n"));
+}
+
+// A failed query leaves the previous archive untouched and no chunk files behind.
+TEST_F(ArchiveTest, FailureKeepsPreviousArchive) {
+    {
+        QFile previous(task_.file_name);
+        ASSERT_TRUE(previous.open(QFile::WriteOnly));
+        previous.write("previous");
+    }
+    task_.entries = {
+        {QStringLiteral("a.csv"), QStringLiteral("x"), QStringLiteral("SELECT 1"), {}},
+        {QStringLiteral("b.csv"), QStringLiteral("x"), QStringLiteral("SELECT * FROM missing"),
+         {}},
+    };
+    const ExportResult result = SaveArchive(task_);
+    EXPECT_EQ(result.status, ExportStatus::kQueryFailed);
+
+    QFile archive(task_.file_name);
+    ASSERT_TRUE(archive.open(QFile::ReadOnly));
+    EXPECT_EQ(archive.readAll(), "previous");
+    EXPECT_FALSE(QFile::exists(task_.file_name + QStringLiteral(".entry0")));
+    EXPECT_FALSE(QFile::exists(task_.file_name + QStringLiteral(".entry1")));
+}
+}  // namespace
+}  // namespace outfit::utils::csv
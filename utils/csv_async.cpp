@@ -0,0 +1,88 @@
+#include "csv_async.h"
+
+#include "csv_writer.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringLiteral>
+
+#include <utility>
+
+namespace outfit::utils::csv {
+AsyncExport::AsyncExport(ExportTask task, QObject* parent)
+    : QObject(parent), task_(std::move(task)) {
+}
+
+AsyncExport::~AsyncExport() {
+    Cancel();
+    if (thread_) {
+        thread_->wait();
+    }
+}
+
+void AsyncExport::Start() {
+    if (IsRunning()) {
+        return;
+    }
+    cancelled_ = false;
+    thread_.reset(QThread::create([this] { Run(); }));
+    thread_->start();
+}
+
+void AsyncExport::Cancel() {
+    cancelled_ = true;
+}
+
+bool AsyncExport::IsRunning() const {
+    return thread_ && thread_->isRunning();
+}
+
+void AsyncExport::Run() {
+    const QString connection =
+        QStringLiteral("csv_export_%1").arg(reinterpret_cast<quintptr>(this), 0, 16);
+    ExportResult result = Export(connection);
+    // Every handle to the connection is gone once Export() returns.
+    QSqlDatabase::removeDatabase(connection);
+    emit Finished(result);
+}
+
+ExportResult AsyncExport::Export(const QString& connection) {
+    QSqlDatabase db = QSqlDatabase::cloneDatabase(task_.connection_name, connection);
+    if (!db.open()) {
+        return {ExportStatus::kOpenFailed, db.lastError().text()};
+    }
+    QSqlQuery query(db);
+    query.prepare(task_.sql);
+    for (const QVariant& value : std::as_const(task_.bind_values)) {
+        query.addBindValue(value);
+    }
+
+    // file_name only appears once the export has succeeded; a failed or cancelled export
+    // leaves no file behind and a previous one untouched.
+    QSaveFile csv_file(task_.file_name);
+    if (!csv_file.open(QFile::WriteOnly | QFile::Text)) {
+        return {ExportStatus::kOpenFailed, csv_file.errorString()};
+    }
+    WriterOptions options;
+    options.on_batch = [this](qint64 rows, qint64 bytes) {
+        emit Progress(rows, bytes);
+        return !cancelled_;
+    };
+    ExportResult result;
+    {
+        Writer writer(csv_file, options);
+        writer.WriteHeader(task_.header);
+        result = writer.WriteQuery(query);
+    }
+    if (!result) {
+        csv_file.cancelWriting();
+    } else if (!csv_file.commit()) {
+        result.status = ExportStatus::kWriteFailed;
+        result.error = csv_file.errorString();
+    }
+    return result;
+}
+}  // namespace outfit::utils::csv
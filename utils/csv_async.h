@@ -0,0 +1,63 @@
+#ifndef CREATIVE_CSV_ASYNC_H
+#define CREATIVE_CSV_ASYNC_H
+
+#include "csv.h"
+
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QVariantList>
+
+#include <atomic>
+#include <memory>
+
+namespace outfit::utils::csv {
+struct ExportTask {
+    // Connection whose settings the worker clones; QSqlDatabase handles cannot cross threads.
+    QString connection_name;
+    QString sql;
+    QVariantList bind_values;
+    // First line of the file, written verbatim; comma-separated like the rows.
+    QString header;
+    QString file_name;
+};
+
+// Runs an export on a worker thread with its own database connection. Progress and the
+// final result are delivered through queued signals. The file is written under a temporary
+// name and only renamed to file_name when the export succeeds.
+class AsyncExport : public QObject {
+    Q_OBJECT
+
+   public:
+    explicit AsyncExport(ExportTask task, QObject* parent = nullptr);
+
+    AsyncExport(const AsyncExport&) = delete;
+    AsyncExport& operator=(const AsyncExport&) = delete;
+    AsyncExport(AsyncExport&&) = delete;
+    AsyncExport& operator=(AsyncExport&&) = delete;
+
+    // Cancels a running export and waits for the worker to stop.
+    ~AsyncExport() override;
+
+    void Start();
+    void Cancel();
+    [[nodiscard]] bool IsRunning() const;
+
+   signals:
+    void Progress(qint64 rows, qint64 bytes);
+    void Finished(const outfit::utils::csv::ExportResult& result);
+
+   private:
+    void Run();
+    [[nodiscard]] ExportResult Export(const QString& connection);
+
+    ExportTask task_;
+    std::atomic<bool> cancelled_ = false;
+    std::unique_ptr<QThread> thread_;
+};
+}  // namespace outfit::utils::csv
+
+Q_DECLARE_METATYPE(outfit::utils::csv::ExportResult)
+
+#endif  // CREATIVE_CSV_ASYNC_H
@@ -0,0 +1,92 @@
+#include "csv_async.h"
+
+#include "test_database.h"
+
+#include <QByteArray>
+#include <QEventLoop>
+#include <QFile>
+#include <QString>
+#include <QStringLiteral>
+#include <QTimer>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::csv {
+namespace {
+QByteArray ReadFile(const QString& file_name) {
+    QFile file(file_name);
+    return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray{};
+}
+
+class AsyncExportTest : public testing::Test {
+   protected:
+    AsyncExportTest() {
+        // More rows than one batch of the writer, so that Progress fires before the end.
+        db_.Exec("CREATE TABLE numbers (id INTEGER)");
+        db_.Exec(
+            "WITH RECURSIVE n(id) AS (SELECT 1 UNION ALL SELECT id + 1 FROM n WHERE id < 3000) "
+            "INSERT INTO numbers SELECT id FROM n");
+        task_.connection_name = db_.ConnectionName();
+        task_.sql = QStringLiteral("SELECT id FROM numbers ORDER BY id");
+        task_.header = QStringLiteral("id");
+        task_.file_name = db_.Path(QStringLiteral("numbers.csv"));
+    }
+
+    // Starts the export, cancelling it right away if asked, and spins an event loop until
+    // Finished arrives.
+    ExportResult Run(bool cancel = false) {
+        AsyncExport exporter(task_);
+        ExportResult result{ExportStatus::kOpenFailed, QStringLiteral("timed out")};
+        QEventLoop loop;
+        QObject::connect(&exporter, &AsyncExport::Progress, &loop, [this] { ++progress_; });
+        QObject::connect(
+            &exporter, &AsyncExport::Finished, &loop, [&](const ExportResult& finished) {
+                result = finished;
+                loop.quit();
+            });
+        QTimer::singleShot(10'000, &loop, &QEventLoop::quit);
+        exporter.Start();
+        if (cancel) {
+            exporter.Cancel();
+        }
+        loop.exec();
+        return result;
+    }
+
+    TestDatabase db_;
+    ExportTask task_;
+    int progress_ = 0;
+};
+
+TEST_F(AsyncExportTest, Completes) {
+    const ExportResult result = Run();
+    ASSERT_TRUE(result) << result.error.toStdString();
+    EXPECT_EQ(result.rows, 3000);
+    EXPECT_GE(progress_, 2);
+
+    QByteArray expected = "id\n";
+    for (int id = 1; id <= 3000; ++id) {
+        expected += QByteArray::number(id) + '\n';
+    }
+    EXPECT_EQ(ReadFile(task_.file_name), expected);
+}
+
+TEST_F(AsyncExportTest, FailedQueryLeavesNoFile) {
+    task_.sql = QStringLiteral("SELECT * FROM missing");
+    EXPECT_EQ(Run().status, ExportStatus::kQueryFailed);
+    EXPECT_FALSE(QFile::exists(task_.file_name));
+}
+
+TEST_F(AsyncExportTest, CancelLeavesNoFile) {
+    EXPECT_EQ(Run(true).status, ExportStatus::kCancelled);
+    EXPECT_FALSE(QFile::exists(task_.file_name));
+}
+
+TEST_F(AsyncExportTest, CancelKeepsPreviousFile) {
+    ASSERT_TRUE(Run());
+    const QByteArray previous = ReadFile(task_.file_name);
+    EXPECT_EQ(Run(true).status, ExportStatus::kCancelled);
+    EXPECT_EQ(ReadFile(task_.file_name), previous);
+}
+}  // namespace
+}  // namespace outfit::utils::csv
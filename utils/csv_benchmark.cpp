@@ -0,0 +1,364 @@
+#include "csv.h"
+#include "csv_loader.h"
+#include "csv_writer.h"
+#include "escape.h"
+#include "tools/util/perf_benchmark.h"
+
+#include <QCoreApplication>
+#include <QIODevice>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVariant>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+std::atomic<int64_t> allocations = 0;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+}  // namespace
+
+// Qt containers allocate with malloc() rather than operator new, so the allocation counter
+// interposes the C allocator. glibc exports its implementation under __libc_* names.
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);                // NOLINT
+void* __libc_calloc(size_t count, size_t size);  // NOLINT
+void* __libc_realloc(void* ptr, size_t size);    // NOLINT
+
+void* malloc(size_t size) {  // NOLINT
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {  // NOLINT
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {  // NOLINT
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+namespace {
+constexpr auto kHeader = "id,price,name,note";
+
+class NullDevice : public QIODevice {
+   public:
+    NullDevice() {
+        open(QIODevice::WriteOnly);
+    }
+
+    [[nodiscard]] qint64 Written() const {
+        return written_;
+    }
+
+   protected:
+    qint64 readData(char* /*data*/, qint64 /*max_size*/) override {
+        return -1;
+    }
+
+    qint64 writeData(const char* /*data*/, qint64 size) override {
+        written_ += size;
+        return size;
+    }
+
+   private:
+    qint64 written_ = 0;
+};
+
+// Counts allocations over the timed loop and reports rows/s, bytes/s and allocations/row.
+class ExportCounters {
+   public:
+    explicit ExportCounters(benchmark::State& state) : state_(state), start_(allocations.load()) {
+    }
+
+    ExportCounters(const ExportCounters&) = delete;
+    ExportCounters& operator=(const ExportCounters&) = delete;
+    ExportCounters(ExportCounters&&) = delete;
+    ExportCounters& operator=(ExportCounters&&) = delete;
+
+    ~ExportCounters() {
+        const int64_t rows = state_.iterations() * state_.range(0);
+        state_.SetItemsProcessed(rows);
+        state_.SetBytesProcessed(bytes_);
+        state_.counters["allocs_per_row"] = static_cast<double>(allocations.load() - start_) /
+                                            static_cast<double>(std::max<int64_t>(rows, 1));
+    }
+
+    void AddBytes(int64_t bytes) {
+        bytes_ += bytes;
+    }
+
+   private:
+    benchmark::State& state_;
+    int64_t start_;
+    int64_t bytes_ = 0;
+};
+
+// Generates the table in SQLite itself; binding millions of rows one by one would dominate
+// the benchmark set-up.
+void FillTable(QSqlDatabase& db, int64_t rows) {
+    QSqlQuery query(db);
+    query.exec("DROP TABLE IF EXISTS export");
+    query.exec("CREATE TABLE export (id INTEGER, price REAL, name TEXT, note TEXT)");
+    query.exec(QStringLiteral(
+                   "INSERT INTO export "
+                   "WITH RECURSIVE seq(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM seq "
+                   "WHERE i + 1 < %1) "
+                   "SELECT i, i * 0.25, "
+                   "CASE WHEN i % 16 = 0 THEN 'ïtem ünïcødé ' ELSE 'item ' END || i, "
+                   "CASE WHEN i % 8 = 0 THEN 'red, \"large\"' ELSE NULL END FROM seq")
+                   .arg(rows));
+    query.exec("DROP TABLE IF EXISTS numbers");
+    query.exec("CREATE TABLE numbers (id INTEGER, quantity INTEGER, price REAL)");
+    query.exec(QStringLiteral(
+                   "INSERT INTO numbers "
+                   "WITH RECURSIVE seq(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM seq "
+                   "WHERE i + 1 < %1) "
+                   "SELECT i, i % 1000, i * 0.25 FROM seq")
+                   .arg(rows));
+}
+
+QSqlDatabase& Database(int64_t rows) {
+    static QSqlDatabase db = [] {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "csv_benchmark");
+        database.setDatabaseName(":memory:");
+        database.open();
+        return database;
+    }();
+    static int64_t filled = -1;
+    if (filled != rows) {
+        FillTable(db, rows);
+        filled = rows;
+    }
+    return db;
+}
+
+// The per-cell QTextStream loop SaveQuery used before the streaming writer.
+void LegacyExport(QSqlQuery& query, QIODevice& device) {
+    query.exec();
+    QTextStream out_stream(&device);
+    out_stream << kHeader << "\n";
+    while (query.next()) {
+        const QSqlRecord record = query.record();
+        for (int i = 0, rec_count = record.count(); i < rec_count; ++i) {
+            if (i > 0) {
+                out_stream << ',';
+            }
+            out_stream << outfit::utils::csv::EscapeCSV(record.value(i).toString());
+        }
+        out_stream << '\n';
+    }
+}
+
+enum FieldMix { kPlain, kCommas, kQuotes, kLongUnicode };
+
+QStringList Fields(FieldMix mix) {
+    QStringList fields;
+    for (int i = 0; i < 1024; ++i) {
+        switch (mix) {
+            case kPlain:
+                fields.push_back(QStringLiteral("item %1").arg(i));
+                break;
+            case kCommas:
+                fields.push_back(QStringLiteral("item %1, size %2").arg(i).arg(i % 7));
+                break;
+            case kQuotes:
+                fields.push_back(QStringLiteral("item \"%1\"").arg(i));
+                break;
+            case kLongUnicode:
+                fields.push_back(
+                    QStringLiteral("Пример длинного описания товара №%1 — ").arg(i).repeated(4));
+                break;
+        }
+    }
+    return fields;
+}
+
+void BM_EscapeCSV(benchmark::State& state) {
+    const QStringList fields = Fields(static_cast<FieldMix>(state.range(0)));
+    int64_t bytes = 0;
+    for (const QString& field : fields) {
+        bytes += field.size() * static_cast<int64_t>(sizeof(QChar));
+    }
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        for (const QString& field : fields) {
+            benchmark::DoNotOptimize(outfit::utils::csv::EscapeCSV(field));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * fields.size());
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+void BM_EscapeInto(benchmark::State& state) {
+    std::vector<std::string> fields;
+    int64_t bytes = 0;
+    for (const QString& field : Fields(static_cast<FieldMix>(state.range(0)))) {
+        fields.push_back(field.toStdString());
+        bytes += static_cast<int64_t>(fields.back().size());
+    }
+    std::string out;
+    const BenchmarkPerfCounters perf{state};
+    for (auto _ : state) {
+        for (const std::string& field : fields) {
+            out.resize(outfit::utils::csv::EscapedSizeBound(field.size()));
+            benchmark::DoNotOptimize(
+                outfit::utils::csv::EscapeInto(field.data(), field.size(), out.data()));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(fields.size()));
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+void BM_LegacyExport(benchmark::State& state) {
+    QSqlDatabase& db = Database(state.range(0));
+    const BenchmarkPerfCounters perf{state};
+    ExportCounters counters(state);
+    for (auto _ : state) {
+        NullDevice device;
+        QSqlQuery query(db);
+        query.prepare("SELECT * FROM export");
+        LegacyExport(query, device);
+        counters.AddBytes(device.Written());
+    }
+}
+
+void BM_Export(benchmark::State& state) {
+    QSqlDatabase& db = Database(state.range(0));
+    const BenchmarkPerfCounters perf{state};
+    ExportCounters counters(state);
+    for (auto _ : state) {
+        NullDevice device;
+        QSqlQuery query(db);
+        query.prepare("SELECT * FROM export");
+        const auto result = outfit::utils::csv::SaveQuery(kHeader, query, device);
+        counters.AddBytes(result.bytes);
+    }
+}
+
+// Every cell of the numbers table takes a typed fast path, which generic_cells_per_row
+// confirms, so the writer builds no QString per cell. allocs_per_row is therefore not zero
+// but what QSqlQuery and the driver allocate per row; compare it with BM_Export, whose text
+// cells add their own QString copies. Same work as SaveQuery with a header, through the
+// writer so that its counters can be read.
+void BM_ExportNumeric(benchmark::State& state) {
+    QSqlDatabase& db = Database(state.range(0));
+    const BenchmarkPerfCounters perf{state};
+    ExportCounters counters(state);
+    qint64 generic_cells = 0;
+    for (auto _ : state) {
+        NullDevice device;
+        QSqlQuery query(db);
+        query.prepare("SELECT * FROM numbers");
+        outfit::utils::csv::Writer writer(device);
+        writer.WriteHeader("id,quantity,price");
+        const auto result = writer.WriteQuery(query);
+        generic_cells += writer.GenericCells();
+        counters.AddBytes(result.bytes);
+    }
+    state.counters["generic_cells_per_row"] =
+        static_cast<double>(generic_cells) /
+        static_cast<double>(std::max<int64_t>(state.iterations() * state.range(0), 1));
+}
+
+void BM_ExportDialect(benchmark::State& state) {
+    QSqlDatabase& db = Database(state.range(0));
+    const outfit::utils::csv::Format format{
+        static_cast<outfit::utils::csv::Format::Separator>(state.range(1)), state.range(2) != 0};
+    const BenchmarkPerfCounters perf{state};
+    ExportCounters counters(state);
+    for (auto _ : state) {
+        NullDevice device;
+        QSqlQuery query(db);
+        query.prepare("SELECT * FROM export");
+        // The header comes from the record, so that it uses the dialect's separator too.
+        const auto result = outfit::utils::csv::SaveQuery(query, device, format);
+        counters.AddBytes(result.bytes);
+    }
+}
+
+void BM_ExportCompressed(benchmark::State& state) {
+    QSqlDatabase& db = Database(state.range(0));
+    const QTemporaryDir dir;
+    const auto compression = static_cast<outfit::utils::csv::Compression>(state.range(1));
+    const QString file_name = dir.filePath("export.csv");
+    const BenchmarkPerfCounters perf{state};
+    ExportCounters counters(state);
+    for (auto _ : state) {
+        QSqlQuery query(db);
+        query.prepare("SELECT * FROM export");
+        const auto result = outfit::utils::csv::SaveQuery(kHeader, query, file_name, compression);
+        counters.AddBytes(result.bytes);
+    }
+}
+
+void BM_Load(benchmark::State& state) {
+    QSqlDatabase& db = Database(state.range(0));
+    const QTemporaryDir dir;
+    const QString file_name = dir.filePath("export.csv");
+    // The second argument exports a schema sidecar, which lets the loader bind typed values.
+    const bool schema = state.range(1) != 0;
+    QSqlQuery export_query(db);
+    export_query.prepare("SELECT * FROM export");
+    const auto exported = outfit::utils::csv::SaveQuery(export_query, file_name, schema);
+    BenchmarkPerfCounters perf{state};
+    ExportCounters counters(state);
+    for (auto _ : state) {
+        // Recreating the table is neither timed nor counted.
+        perf.PauseTiming();
+        QSqlQuery(db).exec("DROP TABLE IF EXISTS load");
+        QSqlQuery(db).exec("CREATE TABLE load (id INTEGER, price REAL, name TEXT, note TEXT)");
+        perf.ResumeTiming();
+        benchmark::DoNotOptimize(outfit::utils::csv::LoadCsv(db, "load", file_name));
+        counters.AddBytes(exported.bytes);
+    }
+}
+
+BENCHMARK(BM_EscapeCSV)->DenseRange(kPlain, kLongUnicode);
+BENCHMARK(BM_EscapeInto)->DenseRange(kPlain, kLongUnicode);
+BENCHMARK(BM_LegacyExport)->Arg(10'000)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Export)->Arg(10'000)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExportNumeric)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExportDialect)
+    ->ArgsProduct(
+        {{1'000'000},
+         {static_cast<int64_t>(outfit::utils::csv::Format::Separator::kComma),
+          static_cast<int64_t>(outfit::utils::csv::Format::Separator::kTab),
+          static_cast<int64_t>(outfit::utils::csv::Format::Separator::kSemicolon),
+          static_cast<int64_t>(outfit::utils::csv::Format::Separator::kPipe)},
+         {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExportCompressed)
+    ->ArgsProduct(
+        {{1'000'000},
+         {static_cast<int64_t>(outfit::utils::csv::Compression::kNone),
+          static_cast<int64_t>(outfit::utils::csv::Compression::kGzip),
+          static_cast<int64_t>(outfit::utils::csv::Compression::kZstd)}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Load)
+    ->ArgsProduct({{10'000, 1'000'000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+}  // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,238 @@
+#include "csv_compress.h"
+
+#include <QStringLiteral>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <utility>
+
+#include <zlib.h>
+#include <zstd.h>
+
+namespace outfit::utils::csv {
+namespace {
+// Blocks queued ahead of the compressor; bounds memory when compression is the slower stage.
+constexpr size_t kMaxPending = 4;
+constexpr size_t kOutputChunk = size_t{256} << 10;
+}  // namespace
+
+class CompressedDevice::Codec {
+   public:
+    Codec() = default;
+    Codec(const Codec&) = delete;
+    Codec& operator=(const Codec&) = delete;
+    Codec(Codec&&) = delete;
+    Codec& operator=(Codec&&) = delete;
+    virtual ~Codec() = default;
+
+    // Compresses the block into target; finish also writes the end of the stream.
+    virtual bool Compress(const char* data, qint64 size, bool finish, QIODevice& target) = 0;
+
+   protected:
+    bool Emit(QIODevice& target, size_t size) {
+        const auto bytes = static_cast<qint64>(size);
+        return size == 0 || target.write(output_.data(), bytes) == bytes;
+    }
+
+    std::vector<char> output_ = std::vector<char>(kOutputChunk);
+};
+
+namespace {
+class GzipCodec : public CompressedDevice::Codec {
+   public:
+    GzipCodec() {
+        // 16 added to the window bits selects the gzip wrapper instead of raw zlib.
+        ok_ = deflateInit2(&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8,
+                           Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    GzipCodec(const GzipCodec&) = delete;
+    GzipCodec& operator=(const GzipCodec&) = delete;
+    GzipCodec(GzipCodec&&) = delete;
+    GzipCodec& operator=(GzipCodec&&) = delete;
+
+    ~GzipCodec() override {
+        if (ok_) {
+            deflateEnd(&stream_);
+        }
+    }
+
+    bool Compress(const char* data, qint64 size, bool finish, QIODevice& target) override {
+        if (!ok_) {
+            return false;
+        }
+        do {  // NOLINT(cppcoreguidelines-avoid-do-while)
+            const auto chunk = static_cast<uInt>(std::min<qint64>(size, UINT_MAX));
+            stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            stream_.avail_in = chunk;
+            data += chunk;
+            size -= chunk;
+            const int flush = finish && size == 0 ? Z_FINISH : Z_NO_FLUSH;
+            int rc = Z_OK;
+            do {  // NOLINT(cppcoreguidelines-avoid-do-while)
+                stream_.next_out = reinterpret_cast<Bytef*>(output_.data());
+                stream_.avail_out = static_cast<uInt>(output_.size());
+                rc = deflate(&stream_, flush);
+                if (rc == Z_STREAM_ERROR || !Emit(target, output_.size() - stream_.avail_out)) {
+                    return false;
+                }
+            } while (stream_.avail_out == 0 || (flush == Z_FINISH && rc != Z_STREAM_END));
+        } while (size > 0);
+        return true;
+    }
+
+   private:
+    z_stream stream_{};
+    bool ok_ = false;
+};
+
+class ZstdCodec : public CompressedDevice::Codec {
+   public:
+    ZstdCodec() : context_(ZSTD_createCCtx()) {
+    }
+
+    ZstdCodec(const ZstdCodec&) = delete;
+    ZstdCodec& operator=(const ZstdCodec&) = delete;
+    ZstdCodec(ZstdCodec&&) = delete;
+    ZstdCodec& operator=(ZstdCodec&&) = delete;
+
+    ~ZstdCodec() override {
+        ZSTD_freeCCtx(context_);
+    }
+
+    bool Compress(const char* data, qint64 size, bool finish, QIODevice& target) override {
+        if (context_ == nullptr) {
+            return false;
+        }
+        ZSTD_inBuffer input{data, static_cast<size_t>(size), 0};
+        const ZSTD_EndDirective mode = finish ? ZSTD_e_end : ZSTD_e_continue;
+        size_t remaining = 0;
+        do {  // NOLINT(cppcoreguidelines-avoid-do-while)
+            ZSTD_outBuffer output{output_.data(), output_.size(), 0};
+            remaining = ZSTD_compressStream2(context_, &output, &input, mode);
+            if (ZSTD_isError(remaining) || !Emit(target, output.pos)) {
+                return false;
+            }
+        } while (finish ? remaining != 0 : input.pos != input.size);
+        return true;
+    }
+
+   private:
+    ZSTD_CCtx* context_;
+};
+
+std::unique_ptr<CompressedDevice::Codec> MakeCodec(Compression compression) {
+    switch (compression) {
+        case Compression::kGzip:
+            return std::make_unique<GzipCodec>();
+        case Compression::kZstd:
+            return std::make_unique<ZstdCodec>();
+        case Compression::kNone:
+            break;
+    }
+    return nullptr;
+}
+}  // namespace
+
+CompressedDevice::CompressedDevice(QIODevice& target, Compression compression)
+    : target_(target), codec_(MakeCodec(compression)) {
+}
+
+CompressedDevice::~CompressedDevice() {
+    close();
+}
+
+bool CompressedDevice::open(OpenMode mode) {
+    if (codec_ == nullptr || mode.testFlag(ReadOnly) || isOpen()) {
+        setErrorString(QStringLiteral("unsupported compression mode"));
+        return false;
+    }
+    // The worker starts only once the device is open, so that Finish(), which joins it,
+    // runs whenever there is a worker.
+    if (!QIODevice::open(mode | Unbuffered)) {
+        return false;
+    }
+    closing_ = false;
+    failed_ = false;
+    worker_ = std::thread([this] { Run(); });
+    return true;
+}
+
+void CompressedDevice::close() {
+    Finish();
+}
+
+bool CompressedDevice::Finish() {
+    if (!isOpen()) {
+        return !failed_;
+    }
+    {
+        const std::lock_guard lock(mutex_);
+        closing_ = true;
+    }
+    ready_.notify_one();
+    worker_.join();
+    QIODevice::close();
+    if (failed_) {
+        setErrorString(QStringLiteral("failed to write compressed data"));
+    }
+    return !failed_;
+}
+
+qint64 CompressedDevice::readData(char* /*data*/, qint64 /*max_size*/) {
+    return -1;
+}
+
+qint64 CompressedDevice::writeData(const char* data, qint64 size) {
+    QByteArray block;
+    {
+        std::unique_lock lock(mutex_);
+        space_.wait(lock, [this] { return pending_.size() < kMaxPending || failed_; });
+        if (failed_) {
+            setErrorString(QStringLiteral("failed to write compressed data"));
+            return -1;
+        }
+        if (!spare_.empty()) {
+            block = std::move(spare_.back());
+            spare_.pop_back();
+        }
+    }
+    // Recycled blocks keep their capacity, so steady-state writes do not allocate.
+    block.resize(size);
+    std::memcpy(block.data(), data, static_cast<size_t>(size));
+    {
+        const std::lock_guard lock(mutex_);
+        pending_.push_back(std::move(block));
+    }
+    ready_.notify_one();
+    return size;
+}
+
+void CompressedDevice::Run() {
+    QByteArray block;
+    bool ok = true;
+    while (true) {
+        {
+            std::unique_lock lock(mutex_);
+            if (!block.isNull()) {
+                spare_.push_back(std::exchange(block, {}));
+            }
+            failed_ = failed_ || !ok;
+            ready_.wait(lock, [this] { return !pending_.empty() || closing_; });
+            if (pending_.empty()) {
+                break;
+            }
+            block = std::move(pending_.front());
+            pending_.pop_front();
+        }
+        space_.notify_one();
+        ok = ok && codec_->Compress(block.constData(), block.size(), false, target_);
+    }
+    if (ok && !codec_->Compress(nullptr, 0, true, target_)) {
+        ok = false;
+    }
+    const std::lock_guard lock(mutex_);
+    failed_ = failed_ || !ok;
+}
+}  // namespace outfit::utils::csv
@@ -0,0 +1,61 @@
+#ifndef CREATIVE_CSV_COMPRESS_H
+#define CREATIVE_CSV_COMPRESS_H
+
+#include "csv.h"
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace outfit::utils::csv {
+// Write-only device that compresses everything written to it into the target device.
+// Blocks are handed to a worker thread, so formatting and compression overlap.
+class CompressedDevice : public QIODevice {
+   public:
+    class Codec;
+
+    CompressedDevice(QIODevice& target, Compression compression);
+
+    CompressedDevice(const CompressedDevice&) = delete;
+    CompressedDevice& operator=(const CompressedDevice&) = delete;
+    CompressedDevice(CompressedDevice&&) = delete;
+    CompressedDevice& operator=(CompressedDevice&&) = delete;
+
+    ~CompressedDevice() override;
+
+    bool open(OpenMode mode) override;
+    void close() override;
+
+    // Drains the pipeline, writes the stream trailer and closes the device. Returns false if
+    // any block failed to compress or reach the target.
+    bool Finish();
+
+   protected:
+    qint64 readData(char* data, qint64 max_size) override;
+    qint64 writeData(const char* data, qint64 size) override;
+
+   private:
+    void Run();
+
+    QIODevice& target_;
+    std::unique_ptr<Codec> codec_;
+    std::thread worker_;
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::condition_variable space_;
+    std::deque<QByteArray> pending_;
+    std::vector<QByteArray> spare_;
+    bool closing_ = false;
+    bool failed_ = false;
+};
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_COMPRESS_H
@@ -0,0 +1,108 @@
+#include "csv_compress.h"
+
+#include <QBuffer>
+#include <QByteArray>
+
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include <zstd.h>
+
+namespace outfit::utils::csv {
+namespace {
+QByteArray Gunzip(const QByteArray& data) {
+    z_stream stream{};
+    EXPECT_EQ(inflateInit2(&stream, MAX_WBITS + 16), Z_OK);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    QByteArray out;
+    std::vector<char> chunk(1 << 16);
+    int rc = Z_OK;
+    while (rc == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef*>(chunk.data());
+        stream.avail_out = static_cast<uInt>(chunk.size());
+        rc = inflate(&stream, Z_NO_FLUSH);
+        out.append(chunk.data(), static_cast<qsizetype>(chunk.size() - stream.avail_out));
+    }
+    EXPECT_EQ(rc, Z_STREAM_END);
+    inflateEnd(&stream);
+    return out;
+}
+
+QByteArray Unzstd(const QByteArray& data) {
+    const unsigned long long size = ZSTD_getFrameContentSize(data.constData(), data.size());
+    // Streamed frames do not record their size.
+    QByteArray out(size == ZSTD_CONTENTSIZE_UNKNOWN ? 1 << 24 : static_cast<qsizetype>(size), '\0');
+    const size_t written =
+        ZSTD_decompress(out.data(), static_cast<size_t>(out.size()), data.constData(), data.size());
+    EXPECT_FALSE(ZSTD_isError(written));
+    out.resize(static_cast<qsizetype>(written));
+    return out;
+}
+
+// Enough rows for several blocks in the pipeline.
+QByteArray Rows() {
+    QByteArray rows;
+    for (int i = 0; i < 50'000; ++i) {
+        rows += QByteArray::number(i) + ",name" + QByteArray::number(i % 97) + "\n";
+    }
+    return rows;
+}
+
+QByteArray Compress(Compression compression, const QByteArray& rows) {
+    QBuffer target;
+    target.open(QBuffer::WriteOnly);
+    CompressedDevice device(target, compression);
+    EXPECT_TRUE(device.open(QIODevice::WriteOnly));
+    for (qsizetype pos = 0; pos < rows.size(); pos += 4096) {
+        const QByteArray block = rows.mid(pos, 4096);
+        EXPECT_EQ(device.write(block), block.size());
+    }
+    EXPECT_TRUE(device.Finish());
+    return target.data();
+}
+
+TEST(CompressedDeviceTest, GzipRoundTrip) {
+    const QByteArray rows = Rows();
+    const QByteArray compressed = Compress(Compression::kGzip, rows);
+    EXPECT_LT(compressed.size(), rows.size());
+    EXPECT_EQ(Gunzip(compressed), rows);
+}
+
+TEST(CompressedDeviceTest, ZstdRoundTrip) {
+    const QByteArray rows = Rows();
+    const QByteArray compressed = Compress(Compression::kZstd, rows);
+    EXPECT_LT(compressed.size(), rows.size());
+    EXPECT_EQ(Unzstd(compressed), rows);
+}
+
+TEST(CompressedDeviceTest, EmptyStream) {
+    EXPECT_EQ(Gunzip(Compress(Compression::kGzip, {})), "");
+    EXPECT_EQ(Unzstd(Compress(Compression::kZstd, {})), "");
+}
+
+// A refused open starts no worker, so destroying the device is safe.
+TEST(CompressedDeviceTest, RefusedOpen) {
+    QBuffer target;
+    target.open(QBuffer::WriteOnly);
+    {
+        CompressedDevice device(target, Compression::kGzip);
+        EXPECT_FALSE(device.open(QIODevice::ReadOnly));
+        EXPECT_FALSE(device.isOpen());
+    }
+    {
+        CompressedDevice device(target, Compression::kNone);
+        EXPECT_FALSE(device.open(QIODevice::WriteOnly));
+    }
+    {
+        CompressedDevice device(target, Compression::kZstd);
+        ASSERT_TRUE(device.open(QIODevice::WriteOnly));
+        EXPECT_FALSE(device.open(QIODevice::WriteOnly));
+        // Closed by the destructor without Finish().
+    }
+    EXPECT_FALSE(target.data().isEmpty());
+}
+}  // namespace
+}  // namespace outfit::utils::csv
@@ -0,0 +1,137 @@
+#include "csv_incremental.h"
+
+#include "csv_writer.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaType>
+#include <QSaveFile>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringLiteral>
+
+namespace outfit::utils::csv {
+namespace {
+struct Checkpoint {
+    QVariant mark;
+    qint64 rows = 0;
+    qint64 bytes = 0;
+};
+
+// The mark is stored as text plus its type, so 64-bit keys survive the JSON round trip and
+// are bound with the same type as the column.
+bool ReadCheckpoint(const QString& file_name, Checkpoint& checkpoint) {
+    QFile file(file_name);
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    if (json.isEmpty()) {
+        return false;
+    }
+    QVariant mark;
+    if (const QMetaType type(json.value("mark_type").toInt()); type.isValid()) {
+        mark = json.value("mark").toString();
+        if (!mark.convert(type)) {
+            return false;
+        }
+    }
+    checkpoint.mark = mark;
+    checkpoint.rows = json.value("rows").toInteger();
+    checkpoint.bytes = json.value("bytes").toInteger();
+    return true;
+}
+
+bool WriteCheckpoint(const QString& file_name, const Checkpoint& checkpoint) {
+    QJsonObject json;
+    json.insert("mark", checkpoint.mark.toString());
+    json.insert("mark_type", checkpoint.mark.metaType().id());
+    json.insert("rows", checkpoint.rows);
+    json.insert("bytes", checkpoint.bytes);
+    // QSaveFile replaces the checkpoint atomically, so a crash leaves the previous one.
+    QSaveFile file(file_name);
+    return file.open(QFile::WriteOnly) && file.write(QJsonDocument(json).toJson()) >= 0 &&
+           file.commit();
+}
+}  // namespace
+
+ExportResult SaveIncremental(QSqlDatabase& db, const IncrementalExportTask& task) {
+    const QString checkpoint_file = task.checkpoint_file.isEmpty()
+                                        ? task.file_name + QStringLiteral(".checkpoint")
+                                        : task.checkpoint_file;
+    Checkpoint checkpoint{task.initial_mark};
+    bool resume = ReadCheckpoint(checkpoint_file, checkpoint);
+    // A missing or shorter file has lost rows that the mark already skips, so it is exported
+    // again from the start rather than padded up to the checkpointed size.
+    if (const QFileInfo info(task.file_name);
+        resume && (!info.exists() || info.size() < checkpoint.bytes)) {
+        checkpoint = Checkpoint{task.initial_mark};
+        resume = false;
+    }
+
+    QFile csv_file(task.file_name);
+    if (resume) {
+        // Anything past the checkpointed size belongs to rows that will be exported again.
+        if (!csv_file.open(QFile::ReadWrite) ||
+            (csv_file.size() > checkpoint.bytes && !csv_file.resize(checkpoint.bytes)) ||
+            !csv_file.seek(checkpoint.bytes)) {
+            return {ExportStatus::kOpenFailed, csv_file.errorString()};
+        }
+    } else if (!csv_file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return {ExportStatus::kOpenFailed, csv_file.errorString()};
+    }
+
+    QSqlQuery query(db);
+    if (!query.prepare(task.sql)) {
+        return {ExportStatus::kQueryFailed, query.lastError().text()};
+    }
+    query.addBindValue(checkpoint.mark);
+
+    const qint64 start_bytes = checkpoint.bytes;
+    Writer* writer = nullptr;
+    auto save = [&] {
+        if (!writer->Flush() || !csv_file.flush()) {
+            return false;
+        }
+        if (writer->RowsWritten() > 0) {
+            checkpoint.mark = writer->Mark();
+        }
+        checkpoint.bytes = start_bytes + writer->BytesWritten();
+        return WriteCheckpoint(checkpoint_file, checkpoint);
+    };
+
+    WriterOptions options;
+    options.mark_column = task.key_column;
+    qint64 checkpointed_rows = 0;
+    options.on_batch = [&](qint64 rows, qint64 /*bytes*/) {
+        if (rows - checkpointed_rows < task.checkpoint_rows) {
+            return true;
+        }
+        checkpoint.rows += rows - checkpointed_rows;
+        checkpointed_rows = rows;
+        return save();
+    };
+    Writer csv_writer(csv_file, options);
+    writer = &csv_writer;
+    if (!resume) {
+        csv_writer.WriteHeader(task.header);
+    }
+    ExportResult result = csv_writer.WriteQuery(query);
+    if (result.status == ExportStatus::kCancelled) {
+        result.status = ExportStatus::kWriteFailed;
+        result.error = QStringLiteral("failed to write checkpoint");
+    }
+    if (!result) {
+        return result;
+    }
+    checkpoint.rows += csv_writer.RowsWritten() - checkpointed_rows;
+    if (!save()) {
+        return csv_writer.Result(
+            ExportStatus::kWriteFailed, QStringLiteral("failed to write checkpoint"));
+    }
+    result.bytes = checkpoint.bytes;
+    return result;
+}
+}  // namespace outfit::utils::csv
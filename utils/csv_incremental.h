@@ -0,0 +1,36 @@
+#ifndef CREATIVE_CSV_INCREMENTAL_H
+#define CREATIVE_CSV_INCREMENTAL_H
+
+#include "csv.h"
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QVariant>
+
+namespace outfit::utils::csv {
+struct IncrementalExportTask {
+    // SELECT with one positional placeholder for the high-water mark, ordered by a key
+    // column, e.g. "... WHERE id > ? ORDER BY id". The key must be unique: a resumed export
+    // skips every row whose key equals the checkpointed mark, so rows sharing a non-unique
+    // key or timestamp with the last checkpointed row would be lost.
+    QString sql;
+    // Index of that key column in the result.
+    int key_column = 0;
+    // Mark bound on the very first run, before any checkpoint exists.
+    QVariant initial_mark;
+    QString header;
+    QString file_name;
+    // Defaults to file_name + ".checkpoint".
+    QString checkpoint_file;
+    // Rows written between two checkpoints.
+    qint64 checkpoint_rows = 100'000;
+};
+
+// Appends the rows past the high-water mark of the previous run to file_name. Progress is
+// checkpointed (mark and file size) as the export goes, so after a crash the next call
+// truncates the torn tail and resumes after the last checkpointed row. If file_name is
+// missing or shorter than the checkpoint, the export starts over from initial_mark.
+ExportResult SaveIncremental(QSqlDatabase& db, const IncrementalExportTask& task);
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_INCREMENTAL_H
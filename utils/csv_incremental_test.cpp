@@ -0,0 +1,103 @@
+#include "csv_incremental.h"
+
+#include "test_database.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringLiteral>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::csv {
+namespace {
+QByteArray ReadFile(const QString& file_name) {
+    QFile file(file_name);
+    return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray{};
+}
+
+class IncrementalTest : public testing::Test {
+   protected:
+    IncrementalTest() {
+        db_.Exec("CREATE TABLE events (id INTEGER PRIMARY KEY, name TEXT)");
+        task_.sql = QStringLiteral("SELECT id, name FROM events WHERE id > ? ORDER BY id");
+        task_.initial_mark = 0;
+        task_.header = QStringLiteral("id,name");
+        task_.file_name = db_.Path(QStringLiteral("events.csv"));
+        task_.checkpoint_rows = 1;
+    }
+
+    void Insert(int from, int to) {
+        for (int id = from; id <= to; ++id) {
+            db_.Exec(QStringLiteral("INSERT INTO events VALUES (%1, 'e%1')").arg(id));
+        }
+    }
+
+    static QByteArray Rows(int from, int to) {
+        QByteArray rows;
+        for (int id = from; id <= to; ++id) {
+            rows += QStringLiteral("%1,e%1\n").arg(id).toUtf8();
+        }
+        return rows;
+    }
+
+    TestDatabase db_;
+    IncrementalExportTask task_;
+};
+
+TEST_F(IncrementalTest, AppendsNewRows) {
+    Insert(1, 3);
+    ExportResult result = SaveIncremental(db_.Db(), task_);
+    ASSERT_TRUE(result) << result.error.toStdString();
+    EXPECT_EQ(result.rows, 3);
+
+    Insert(4, 5);
+    result = SaveIncremental(db_.Db(), task_);
+    ASSERT_TRUE(result) << result.error.toStdString();
+    EXPECT_EQ(result.rows, 2);
+    const QByteArray expected = "id,name\n" + Rows(1, 5);
+    EXPECT_EQ(ReadFile(task_.file_name), expected);
+    EXPECT_EQ(result.bytes, expected.size());
+
+    // Nothing new: the file stays as it is.
+    result = SaveIncremental(db_.Db(), task_);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.rows, 0);
+    EXPECT_EQ(ReadFile(task_.file_name), expected);
+}
+
+// A crash after the last checkpoint leaves rows past the checkpointed size; they are cut
+// off and written again.
+TEST_F(IncrementalTest, ResumeTruncatesTornTail) {
+    Insert(1, 3);
+    ASSERT_TRUE(SaveIncremental(db_.Db(), task_));
+    {
+        QFile file(task_.file_name);
+        ASSERT_TRUE(file.open(QFile::Append));
+        file.write("4,e4\n5,e");
+    }
+    Insert(4, 5);
+    ASSERT_TRUE(SaveIncremental(db_.Db(), task_));
+    EXPECT_EQ(ReadFile(task_.file_name), "id,name\n" + Rows(1, 5));
+}
+
+// Without the rows the checkpoint counts, the file is exported again from the start
+// instead of being padded with NULs.
+TEST_F(IncrementalTest, MissingOrShortFileRestarts) {
+    Insert(1, 3);
+    ASSERT_TRUE(SaveIncremental(db_.Db(), task_));
+    ASSERT_TRUE(QFile::remove(task_.file_name));
+    Insert(4, 4);
+    ExportResult result = SaveIncremental(db_.Db(), task_);
+    ASSERT_TRUE(result) << result.error.toStdString();
+    EXPECT_EQ(result.rows, 4);
+    EXPECT_EQ(ReadFile(task_.file_name), "id,name\n" + Rows(1, 4));
+
+    ASSERT_TRUE(QFile::resize(task_.file_name, 5));
+    result = SaveIncremental(db_.Db(), task_);
+    ASSERT_TRUE(result) << result.error.toStdString();
+    EXPECT_EQ(ReadFile(task_.file_name), "id,name\n" + Rows(1, 4));
+    EXPECT_FALSE(ReadFile(task_.file_name).contains('\0'));
+}
+}  // namespace
+}  // namespace outfit::utils::csv
@@ -0,0 +1,219 @@
+#include "csv_loader.h"
+
+#include "csv_parser.h"
+#include "csv_schema.h"
+
+#include <QFile>
+#include <QMetaType>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QStringLiteral>
+#include <QVariant>
+#include <QVariantList>
+
+#include <algorithm>
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace outfit::utils::csv {
+namespace {
+QString ToString(std::string_view field) {
+    return QString::fromUtf8(field.data(), static_cast<qsizetype>(field.size()));
+}
+
+enum class ColumnKind { kText, kInteger, kReal };
+
+ColumnKind KindOf(QMetaType type) {
+    switch (type.id()) {
+        case QMetaType::Short:
+        case QMetaType::UShort:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::Long:
+        case QMetaType::LongLong:
+            return ColumnKind::kInteger;
+        case QMetaType::Float:
+        case QMetaType::Double:
+            return ColumnKind::kReal;
+        default:
+            return ColumnKind::kText;
+    }
+}
+
+// Column kinds from the sidecar, or all text when there is none or it describes other
+// columns than the header.
+std::vector<ColumnKind> ColumnKinds(
+    const std::optional<Schema>& schema, const std::vector<std::string_view>& header) {
+    std::vector<ColumnKind> kinds(header.size(), ColumnKind::kText);
+    if (!schema || schema->columns.size() != static_cast<qsizetype>(header.size())) {
+        return kinds;
+    }
+    for (size_t i = 0; i < header.size(); ++i) {
+        if (schema->columns[static_cast<qsizetype>(i)].name != ToString(header[i])) {
+            return std::vector<ColumnKind>(header.size(), ColumnKind::kText);
+        }
+        kinds[i] = KindOf(schema->columns[static_cast<qsizetype>(i)].type);
+    }
+    return kinds;
+}
+
+// Fields that do not parse completely as the column's type are bound as text.
+QVariant Convert(std::string_view field, ColumnKind kind) {
+    const char* end = field.data() + field.size();
+    switch (kind) {
+        case ColumnKind::kInteger: {
+            qlonglong value = 0;
+            const auto [ptr, error] = std::from_chars(field.data(), end, value);
+            if (error == std::errc{} && ptr == end) {
+                return value;
+            }
+            break;
+        }
+        case ColumnKind::kReal: {
+#if defined(__cpp_lib_to_chars)
+            double value = 0;
+            const auto [ptr, error] = std::from_chars(field.data(), end, value);
+            if (error == std::errc{} && ptr == end) {
+                return value;
+            }
+#endif
+            break;
+        }
+        case ColumnKind::kText:
+            break;
+    }
+    return ToString(field);
+}
+
+QString InsertStatement(
+    const QSqlDatabase& db, const QString& table, const std::vector<std::string_view>& header) {
+    const QSqlDriver* driver = db.driver();
+    QStringList columns;
+    QStringList placeholders;
+    for (const std::string_view name : header) {
+        columns.push_back(driver->escapeIdentifier(ToString(name), QSqlDriver::FieldName));
+        placeholders.push_back(QStringLiteral("?"));
+    }
+    return QStringLiteral("INSERT INTO %1 (%2) VALUES (%3)")
+        .arg(driver->escapeIdentifier(table, QSqlDriver::TableName), columns.join(','),
+             placeholders.join(','));
+}
+
+class BatchInserter {
+   public:
+    BatchInserter(
+        QSqlQuery& query, std::vector<ColumnKind> kinds, int batch_size, qsizetype expected_rows)
+        : query_(query)
+        , kinds_(std::move(kinds))
+        , values_(kinds_.size())
+        , batch_size_(batch_size) {
+        const qsizetype capacity = std::min<qsizetype>(batch_size_, expected_rows);
+        for (QVariantList& column : values_) {
+            column.reserve(capacity);
+        }
+    }
+
+    bool Add(const std::vector<std::string_view>& fields, bool empty_as_null) {
+        for (size_t i = 0; i < values_.size(); ++i) {
+            const std::string_view field = fields[i];
+            values_[i].push_back(
+                field.empty() && empty_as_null ? QVariant{} : Convert(field, kinds_[i]));
+        }
+        ++rows_;
+        return rows_ < batch_size_ || Execute();
+    }
+
+    bool Execute() {
+        if (rows_ == 0) {
+            return true;
+        }
+        for (QVariantList& column : values_) {
+            query_.addBindValue(column);
+            column.clear();
+        }
+        rows_ = 0;
+        return query_.execBatch();
+    }
+
+   private:
+    QSqlQuery& query_;
+    std::vector<ColumnKind> kinds_;
+    std::vector<QVariantList> values_;
+    int batch_size_;
+    int rows_ = 0;
+};
+}  // namespace
+
+ExportResult LoadCsv(
+    QSqlDatabase& db, const QString& table, const QString& file_name, LoaderOptions options) {
+    QFile csv_file(file_name);
+    if (!csv_file.open(QFile::ReadOnly)) {
+        return {ExportStatus::kOpenFailed, csv_file.errorString()};
+    }
+    const qint64 size = csv_file.size();
+    const uchar* mapped = size > 0 ? csv_file.map(0, size) : nullptr;
+    if (size > 0 && mapped == nullptr) {
+        return {ExportStatus::kOpenFailed, csv_file.errorString()};
+    }
+    Parser parser({reinterpret_cast<const char*>(mapped), static_cast<size_t>(size)});
+    std::vector<std::string_view> fields;
+    if (!parser.Next(fields)) {
+        return {ExportStatus::kParseFailed, QStringLiteral("missing header row")};
+    }
+    const size_t columns = fields.size();
+
+    if (!db.transaction()) {
+        return {ExportStatus::kQueryFailed, db.lastError().text()};
+    }
+    QSqlQuery query(db);
+    if (!query.prepare(InsertStatement(db, table, fields))) {
+        db.rollback();
+        return {ExportStatus::kQueryFailed, query.lastError().text()};
+    }
+    const std::optional<Schema> schema =
+        options.use_schema ? ReadSchema(SchemaFileName(file_name)) : std::nullopt;
+    const qsizetype expected_rows = schema ? schema->rows : options.batch_size;
+    BatchInserter inserter(query, ColumnKinds(schema, fields), options.batch_size, expected_rows);
+    ExportResult result;
+    while (parser.Next(fields)) {
+        if (fields.size() != columns) {
+            result.status = ExportStatus::kParseFailed;
+            result.error = QStringLiteral("row %1 has %2 fields, expected %3")
+                               .arg(result.rows + 1)
+                               .arg(fields.size())
+                               .arg(columns);
+            break;
+        }
+        if (!inserter.Add(fields, options.empty_as_null)) {
+            result.status = ExportStatus::kQueryFailed;
+            result.error = query.lastError().text();
+            break;
+        }
+        ++result.rows;
+    }
+    if (result && parser.Failed()) {
+        result.status = ExportStatus::kParseFailed;
+        result.error = QStringLiteral("malformed record at byte %1").arg(parser.Position());
+    }
+    if (result && !inserter.Execute()) {
+        result.status = ExportStatus::kQueryFailed;
+        result.error = query.lastError().text();
+    }
+    if (!result || !db.commit()) {
+        db.rollback();
+        if (result) {
+            result.status = ExportStatus::kQueryFailed;
+            result.error = db.lastError().text();
+        }
+        return result;
+    }
+    result.bytes = size;
+    return result;
+}
+}  // namespace outfit::utils::csv
@@ -0,0 +1,27 @@
+#ifndef CREATIVE_CSV_LOADER_H
+#define CREATIVE_CSV_LOADER_H
+
+#include "csv.h"
+
+#include <QSqlDatabase>
+#include <QString>
+
+namespace outfit::utils::csv {
+struct LoaderOptions {
+    // Rows bound per QSqlQuery::execBatch() call.
+    int batch_size = 10'000;
+    // Binds empty fields as NULL, mirroring how the writer exports NULL.
+    bool empty_as_null = true;
+    // Reads the SchemaFileName() sidecar, when there is one that matches the header, to
+    // bind integer and floating-point columns as numbers and size the batches up front.
+    bool use_schema = true;
+};
+
+// Loads a CSV file with a header row into an existing table. The file is memory-mapped,
+// parsed with Parser and inserted through one prepared statement in batched execBatch()
+// calls inside a single transaction; nothing is committed if any row fails.
+ExportResult LoadCsv(
+    QSqlDatabase& db, const QString& table, const QString& file_name, LoaderOptions options = {});
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_LOADER_H
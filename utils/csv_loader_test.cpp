@@ -0,0 +1,108 @@
+#include "csv_loader.h"
+
+#include "csv.h"
+#include "csv_schema.h"
+#include "test_database.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QMetaType>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QStringLiteral>
+
+#include <optional>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::csv {
+namespace {
+const QStringList kCopied = {
+    "1:integer 2.5:real 'a,b'", "2:integer NULL:null 'c'", "3:integer 4.0:real NULL"};
+
+QByteArray ReadFile(const QString& file_name) {
+    QFile file(file_name);
+    return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray{};
+}
+
+void WriteFile(const QString& file_name, const QByteArray& data) {
+    QFile file(file_name);
+    ASSERT_TRUE(file.open(QFile::WriteOnly));
+    ASSERT_EQ(file.write(data), data.size());
+}
+
+class LoaderTest : public testing::Test {
+   protected:
+    LoaderTest() {
+        db_.Exec("CREATE TABLE items (id INTEGER, price REAL, name TEXT)");
+        db_.Exec("INSERT INTO items VALUES (1, 2.5, 'a,b'), (2, NULL, 'c'), (3, 4, NULL)");
+        db_.Exec("CREATE TABLE copy (id INTEGER, price REAL, name TEXT)");
+        file_name_ = db_.Path(QStringLiteral("items.csv"));
+    }
+
+    ExportResult Save() {
+        QSqlQuery query(db_.Db());
+        query.prepare(QStringLiteral("SELECT id, price, name FROM items ORDER BY id"));
+        return SaveQuery(query, file_name_, true);
+    }
+
+    // Rows of the copy with the storage class of every cell, e.g. "1:integer".
+    QStringList Copied() {
+        QSqlQuery query(db_.Db());
+        EXPECT_TRUE(query.exec(
+            "SELECT id || ':' || typeof(id), quote(price) || ':' || typeof(price), "
+            "quote(name) FROM copy ORDER BY rowid"));
+        QStringList rows;
+        while (query.next()) {
+            rows.push_back(
+                query.value(0).toString() + ' ' + query.value(1).toString() + ' ' +
+                query.value(2).toString());
+        }
+        return rows;
+    }
+
+    TestDatabase db_;
+    QString file_name_;
+};
+
+TEST_F(LoaderTest, HeaderAndSchemaFromRecord) {
+    const ExportResult result = Save();
+    ASSERT_TRUE(result) << result.error.toStdString();
+    EXPECT_EQ(ReadFile(file_name_), "id,price,name\n1,2.5,\"a,b\"\n2,,c\n3,4,\n");
+
+    const std::optional<Schema> schema = ReadSchema(SchemaFileName(file_name_));
+    ASSERT_TRUE(schema);
+    EXPECT_EQ(schema->rows, 3);
+    ASSERT_EQ(schema->columns.size(), 3);
+    EXPECT_EQ(schema->columns[0].name, "id");
+    EXPECT_EQ(schema->columns[1].name, "price");
+    EXPECT_EQ(schema->columns[2].name, "name");
+    EXPECT_EQ(schema->columns[2].type, QMetaType::fromType<QString>());
+}
+
+TEST_F(LoaderTest, RoundTrip) {
+    ASSERT_TRUE(Save());
+    const ExportResult result = LoadCsv(db_.Db(), QStringLiteral("copy"), file_name_);
+    ASSERT_TRUE(result) << result.error.toStdString();
+    EXPECT_EQ(result.rows, 3);
+    EXPECT_EQ(Copied(), kCopied);
+}
+
+TEST_F(LoaderTest, WithoutSchemaBindsText) {
+    ASSERT_TRUE(Save());
+    ASSERT_TRUE(QFile::remove(SchemaFileName(file_name_)));
+    ASSERT_TRUE(LoadCsv(db_.Db(), QStringLiteral("copy"), file_name_));
+    // The fields are bound as text; the column affinities convert them to the same values.
+    EXPECT_EQ(Copied(), kCopied);
+}
+
+TEST_F(LoaderTest, BadRowRollsBack) {
+    WriteFile(file_name_, "id,name\n1,a\n2,b\n3\n");
+    const ExportResult result =
+        LoadCsv(db_.Db(), QStringLiteral("copy"), file_name_, {.batch_size = 1});
+    EXPECT_EQ(result.status, ExportStatus::kParseFailed);
+    EXPECT_TRUE(Copied().isEmpty());
+}
+}  // namespace
+}  // namespace outfit::utils::csv
@@ -0,0 +1,101 @@
+#include "csv_parser.h"
+
+#include "escape.h"
+
+#include <cstring>
+
+namespace outfit::utils::csv {
+Parser::Parser(std::string_view data) : data_(data) {
+}
+
+bool Parser::Next(std::vector<std::string_view>& fields) {
+    fields.clear();
+    if (failed_ || pos_ >= data_.size()) {
+        return false;
+    }
+    scratch_.clear();
+    spans_.clear();
+    const char* data = data_.data();
+    const std::size_t size = data_.size();
+    while (true) {
+        Span span{pos_, 0, false};
+        // After a delimiter at the very end pos_ == size: the record ends in an empty field.
+        if (pos_ < size && data[pos_] == '"') {
+            if (!ReadQuoted(span)) {
+                failed_ = true;
+                return false;
+            }
+        } else {
+            // A stray quote inside an unquoted field is kept as data.
+            std::size_t end = pos_ + FindSpecial(data + pos_, size - pos_);
+            while (end < size && data[end] == '"') {
+                ++end;
+                end += FindSpecial(data + end, size - end);
+            }
+            span.size = end - pos_;
+            pos_ = end;
+        }
+        spans_.push_back(span);
+        if (pos_ >= size) {
+            break;
+        }
+        const char delimiter = data[pos_++];
+        if (delimiter == ',') {
+            continue;
+        }
+        if (delimiter == '\r' && pos_ < size && data[pos_] == '\n') {
+            ++pos_;
+        } else if (delimiter != '\r' && delimiter != '\n') {
+            failed_ = true;
+            return false;
+        }
+        break;
+    }
+    for (const Span& span : spans_) {
+        fields.emplace_back((span.unescaped ? scratch_.data() : data) + span.offset, span.size);
+    }
+    return true;
+}
+
+bool Parser::ReadQuoted(Span& span) {
+    const char* data = data_.data();
+    const std::size_t size = data_.size();
+    std::size_t from = pos_ + 1;
+    span.offset = from;
+    while (true) {
+        const void* quote = std::memchr(data + from, '"', size - from);
+        if (quote == nullptr) {
+            return false;
+        }
+        const auto end = static_cast<std::size_t>(static_cast<const char*>(quote) - data);
+        if (end + 1 < size && data[end + 1] == '"') {
+            // Doubled quote: switch to the scratch copy and keep one of the two.
+            if (!span.unescaped) {
+                span.unescaped = true;
+                span.offset = scratch_.size();
+                scratch_.append(data + pos_ + 1, end + 1 - (pos_ + 1));
+            } else {
+                scratch_.append(data + from, end + 1 - from);
+            }
+            from = end + 2;
+            continue;
+        }
+        if (span.unescaped) {
+            scratch_.append(data + from, end - from);
+            span.size = scratch_.size() - span.offset;
+        } else {
+            span.size = end - span.offset;
+        }
+        pos_ = end + 1;
+        return true;
+    }
+}
+
+bool Parser::Failed() const {
+    return failed_;
+}
+
+std::size_t Parser::Position() const {
+    return pos_;
+}
+}  // namespace outfit::utils::csv
@@ -0,0 +1,41 @@
+#ifndef CREATIVE_CSV_PARSER_H
+#define CREATIVE_CSV_PARSER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace outfit::utils::csv {
+// RFC 4180 reader over an in-memory (usually memory-mapped) buffer. Unquoted fields and
+// quoted fields without doubled quotes are returned as views into the buffer; only fields
+// that need unescaping are copied, into storage reused between records.
+class Parser {
+   public:
+    explicit Parser(std::string_view data);
+
+    // Splits the next record into fields, which stay valid until the next call. Returns
+    // false at the end of the data or on a malformed record (see Failed()).
+    bool Next(std::vector<std::string_view>& fields);
+
+    [[nodiscard]] bool Failed() const;
+    [[nodiscard]] std::size_t Position() const;
+
+   private:
+    struct Span {
+        std::size_t offset;
+        std::size_t size;
+        bool unescaped;
+    };
+
+    bool ReadQuoted(Span& span);
+
+    std::string_view data_;
+    std::size_t pos_ = 0;
+    bool failed_ = false;
+    std::string scratch_;
+    std::vector<Span> spans_;
+};
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_PARSER_H
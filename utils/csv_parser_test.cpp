@@ -0,0 +1,92 @@
+#include "csv_parser.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::csv {
+namespace {
+using Record = std::vector<std::string>;
+
+// Parses all of data; fields are copied since they only live until the next record.
+std::vector<Record> ParseAll(std::string_view data, bool* failed = nullptr) {
+    Parser parser(data);
+    std::vector<Record> records;
+    std::vector<std::string_view> fields;
+    while (parser.Next(fields)) {
+        records.emplace_back(fields.begin(), fields.end());
+    }
+    if (failed != nullptr) {
+        *failed = parser.Failed();
+    }
+    return records;
+}
+
+TEST(ParserTest, Empty) {
+    bool failed = true;
+    EXPECT_TRUE(ParseAll("", &failed).empty());
+    EXPECT_FALSE(failed);
+}
+
+TEST(ParserTest, LineEndings) {
+    const std::vector<Record> expected{{"a", "b"}, {"c", "d"}};
+    EXPECT_EQ(ParseAll("a,b\nc,d\n"), expected);
+    EXPECT_EQ(ParseAll("a,b\r\nc,d\r\n"), expected);
+    EXPECT_EQ(ParseAll("a,b\r\nc,d\n"), expected);
+    EXPECT_EQ(ParseAll("a,b\rc,d\r"), expected);
+}
+
+TEST(ParserTest, MissingFinalNewline) {
+    bool failed = true;
+    EXPECT_EQ(ParseAll("a,b\nc,d", &failed), (std::vector<Record>{{"a", "b"}, {"c", "d"}}));
+    EXPECT_FALSE(failed);
+    EXPECT_EQ(ParseAll("a,\"b\""), (std::vector<Record>{{"a", "b"}}));
+    EXPECT_EQ(ParseAll("a,"), (std::vector<Record>{{"a", ""}}));
+}
+
+TEST(ParserTest, EmptyFields) {
+    EXPECT_EQ(ParseAll(",\n\"\",x\n"), (std::vector<Record>{{"", ""}, {"", "x"}}));
+}
+
+TEST(ParserTest, QuotedLineBreaks) {
+    EXPECT_EQ(
+        ParseAll("\"a\r\nb\",\"c\nd\"\r\n\"e\rf\",g\n"),
+        (std::vector<Record>{{"a\r\nb", "c\nd"}, {"e\rf", "g"}}));
+}
+
+TEST(ParserTest, DoubledQuotes) {
+    EXPECT_EQ(
+        ParseAll("\"say \"\"hi\"\"\",plain,\"\"\"\"\n\"x,\"\"y\"\"\"\n"),
+        (std::vector<Record>{{"say \"hi\"", "plain", "\""}, {"x,\"y\""}}));
+}
+
+TEST(ParserTest, StrayQuoteInUnquotedField) {
+    EXPECT_EQ(ParseAll("a\"b,c\n"), (std::vector<Record>{{"a\"b", "c"}}));
+}
+
+TEST(ParserTest, QuoteOpenAtEnd) {
+    bool failed = false;
+    EXPECT_EQ(ParseAll("a,b\nc,\"d\n", &failed), (std::vector<Record>{{"a", "b"}}));
+    EXPECT_TRUE(failed);
+}
+
+TEST(ParserTest, TextAfterClosingQuote) {
+    bool failed = false;
+    EXPECT_TRUE(ParseAll("\"a\"b,c\n", &failed).empty());
+    EXPECT_TRUE(failed);
+}
+
+TEST(ParserTest, Position) {
+    Parser parser("a,b\r\nc\n");
+    std::vector<std::string_view> fields;
+    ASSERT_TRUE(parser.Next(fields));
+    EXPECT_EQ(parser.Position(), 5U);
+    ASSERT_TRUE(parser.Next(fields));
+    EXPECT_EQ(parser.Position(), 7U);
+    EXPECT_FALSE(parser.Next(fields));
+    EXPECT_FALSE(parser.Failed());
+}
+}  // namespace
+}  // namespace outfit::utils::csv
@@ -0,0 +1,191 @@
+#include "csv_partitioned.h"
+
+#include "csv_writer.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringLiteral>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace outfit::utils::csv {
+namespace {
+constexpr qint64 kCopyBlock = qint64{1} << 20;
+
+struct Partition {
+    qint64 from = 0;
+    qint64 to = 0;
+    QString chunk_name;
+    ExportResult result;
+};
+
+ExportResult ExportPartition(
+    const PartitionedExportTask& task, const Partition& partition, QSqlDatabase& db) {
+    QFile chunk(partition.chunk_name);
+    if (!chunk.open(QFile::WriteOnly | QFile::Text)) {
+        return {ExportStatus::kOpenFailed, chunk.errorString()};
+    }
+    QSqlQuery query(db);
+    query.prepare(task.sql);
+    query.addBindValue(partition.from);
+    query.addBindValue(partition.to);
+    Writer writer(chunk);
+    return writer.WriteQuery(query);
+}
+
+// Takes partitions off the shared counter until none are left, all on one connection.
+void RunWorker(
+    const PartitionedExportTask& task, std::vector<Partition>& partitions, std::atomic<int>& next,
+    int worker) {
+    const QString connection = QStringLiteral("csv_partition_%1_%2")
+                                   .arg(reinterpret_cast<quintptr>(&task), 0, 16)
+                                   .arg(worker);
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(task.connection_name, connection);
+        const bool opened = db.open();
+        for (int index = next++; index < static_cast<int>(partitions.size()); index = next++) {
+            Partition& partition = partitions[index];
+            if (!opened) {
+                partition.result = {ExportStatus::kOpenFailed, db.lastError().text()};
+            } else {
+                partition.result = ExportPartition(task, partition, db);
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(connection);
+}
+
+#ifdef __linux__
+// copy_file_range() lets the filesystem share or copy the extents without moving the
+// data through user space; plain read/write covers the cases it rejects (e.g. EXDEV).
+bool CopyChunk(int in, int out, qint64 size) {
+    while (size > 0) {
+        const ssize_t copied = ::copy_file_range(
+            in, nullptr, out, nullptr, static_cast<size_t>(std::min(size, kCopyBlock)), 0);
+        if (copied <= 0) {
+            break;
+        }
+        size -= copied;
+    }
+    std::vector<char> block;
+    while (size > 0) {
+        block.resize(static_cast<size_t>(kCopyBlock));
+        const ssize_t received = ::read(in, block.data(), block.size());
+        if (received <= 0) {
+            return false;
+        }
+        for (ssize_t done = 0; done < received;) {
+            const ssize_t written = ::write(out, block.data() + done, received - done);
+            if (written < 0) {
+                return false;
+            }
+            done += written;
+        }
+        size -= received;
+    }
+    return true;
+}
+#endif
+
+bool AppendChunk(QFileDevice& out, const QString& chunk_name) {
+    QFile chunk(chunk_name);
+    if (!chunk.open(QFile::ReadOnly)) {
+        return false;
+    }
+#ifdef __linux__
+    return CopyChunk(chunk.handle(), out.handle(), chunk.size());
+#else
+    while (!chunk.atEnd()) {
+        const QByteArray block = chunk.read(kCopyBlock);
+        if (block.isEmpty() || out.write(block) != block.size()) {
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+}  // namespace
+
+ExportResult SavePartitioned(const PartitionedExportTask& task) {
+    const int count =
+        std::max(1, task.partitions > 0 ? task.partitions : QThread::idealThreadCount());
+    // The span of [INT64_MIN, INT64_MAX) does not fit in qint64, so the keys are split in
+    // quint64; the first span % count partitions get one key more.
+    quint64 span = 0;
+    if (task.key_end > task.key_begin) {
+        span = static_cast<quint64>(task.key_end) - static_cast<quint64>(task.key_begin);
+    }
+    const auto key = [&](int i) {
+        const auto index = static_cast<quint64>(i);
+        const quint64 offset = span / count * index + std::min<quint64>(index, span % count);
+        return static_cast<qint64>(static_cast<quint64>(task.key_begin) + offset);
+    };
+
+    std::vector<Partition> partitions(count);
+    for (int i = 0; i < count; ++i) {
+        Partition& partition = partitions[i];
+        partition.from = key(i);
+        partition.to = key(i + 1);
+        partition.chunk_name = QStringLiteral("%1.part%2").arg(task.file_name).arg(i);
+    }
+    std::atomic<int> next = 0;
+    const int threads =
+        std::clamp(task.threads > 0 ? task.threads : QThread::idealThreadCount(), 1, count);
+    std::vector<std::unique_ptr<QThread>> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(QThread::create([&task, &partitions, &next, i] {
+            RunWorker(task, partitions, next, i);
+        }));
+        workers.back()->start();
+    }
+    for (const auto& worker : workers) {
+        worker->wait();
+    }
+
+    // The joined file only replaces task.file_name once every chunk made it in; on any
+    // failure QSaveFile drops it and a previous export stays in place.
+    ExportResult result;
+    QSaveFile csv_file(task.file_name);
+    if (!csv_file.open(QFile::WriteOnly | QFile::Text)) {
+        result = {ExportStatus::kOpenFailed, csv_file.errorString()};
+    } else {
+        {
+            Writer writer(csv_file);
+            writer.WriteHeader(task.header);
+        }
+        csv_file.flush();
+        for (const Partition& partition : partitions) {
+            if (!partition.result) {
+                result = partition.result;
+                break;
+            }
+            if (!AppendChunk(csv_file, partition.chunk_name)) {
+                result = {ExportStatus::kWriteFailed, QStringLiteral("failed to join chunks")};
+                break;
+            }
+            result.rows += partition.result.rows;
+        }
+        if (result) {
+            result.bytes = csv_file.size();
+            if (!csv_file.commit()) {
+                result = {ExportStatus::kWriteFailed, csv_file.errorString()};
+            }
+        }
+    }
+    for (const Partition& partition : partitions) {
+        QFile::remove(partition.chunk_name);
+    }
+    return result;
+}
+}  // namespace outfit::utils::csv
@@ -0,0 +1,33 @@
+#ifndef CREATIVE_CSV_PARTITIONED_H
+#define CREATIVE_CSV_PARTITIONED_H
+
+#include "csv.h"
+
+#include <QString>
+
+namespace outfit::utils::csv {
+struct PartitionedExportTask {
+    // Connection whose settings every worker clones for its own QSqlDatabase.
+    QString connection_name;
+    // SELECT with two positional placeholders that bound the key range of a partition,
+    // e.g. "... WHERE id >= ? AND id < ? ORDER BY id".
+    QString sql;
+    qint64 key_begin = 0;
+    qint64 key_end = 0;
+    // Number of key ranges; 0 means QThread::idealThreadCount().
+    int partitions = 0;
+    // Partitions exported at the same time, each worker thread with its own connection;
+    // 0 means QThread::idealThreadCount(). Further partitions wait for a free worker.
+    int threads = 0;
+    // First line of the file, written verbatim; comma-separated like the rows.
+    QString header;
+    QString file_name;
+};
+
+// Splits [key_begin, key_end) into equal ranges, exports them on at most `threads` worker
+// threads into chunk files and joins the chunks in key order behind the header. file_name is only
+// replaced when the whole export succeeds.
+ExportResult SavePartitioned(const PartitionedExportTask& task);
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_PARTITIONED_H
@@ -0,0 +1,78 @@
+#include "csv_partitioned.h"
+
+#include "test_database.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringLiteral>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::csv {
+namespace {
+QByteArray ReadFile(const QString& file_name) {
+    QFile file(file_name);
+    return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray{};
+}
+
+class PartitionedTest : public testing::Test {
+   protected:
+    PartitionedTest() {
+        db_.Exec("CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT)");
+        db_.Exec(
+            "WITH RECURSIVE s(n) AS (SELECT 0 UNION ALL SELECT n + 1 FROM s WHERE n < 999) "
+            "INSERT INTO items SELECT n, 'item' || n FROM s");
+        task_.connection_name = db_.ConnectionName();
+        task_.sql =
+            QStringLiteral("SELECT id, name FROM items WHERE id >= ? AND id < ? ORDER BY id");
+        task_.key_begin = 0;
+        task_.key_end = 1000;
+        task_.header = QStringLiteral("id,name");
+        task_.file_name = db_.Path(QStringLiteral("items.csv"));
+    }
+
+    static QByteArray Expected() {
+        QByteArray expected = "id,name\n";
+        for (int id = 0; id < 1000; ++id) {
+            expected += QStringLiteral("%1,item%1\n").arg(id).toUtf8();
+        }
+        return expected;
+    }
+
+    TestDatabase db_;
+    PartitionedExportTask task_;
+};
+
+// More partitions than workers: the rest wait for a free worker and the chunks are still
+// joined in key order.
+TEST_F(PartitionedTest, MorePartitionsThanThreads) {
+    task_.partitions = 13;
+    task_.threads = 2;
+    const ExportResult result = SavePartitioned(task_);
+    ASSERT_TRUE(result) << result.error.toStdString();
+    EXPECT_EQ(result.rows, 1000);
+    EXPECT_EQ(ReadFile(task_.file_name), Expected());
+    EXPECT_FALSE(QFile::exists(task_.file_name + QStringLiteral(".part0")));
+}
+
+TEST_F(PartitionedTest, SingleThread) {
+    task_.partitions = 4;
+    task_.threads = 1;
+    ASSERT_TRUE(SavePartitioned(task_));
+    EXPECT_EQ(ReadFile(task_.file_name), Expected());
+}
+
+TEST_F(PartitionedTest, FailedQueryKeepsPreviousFile) {
+    {
+        QFile previous(task_.file_name);
+        ASSERT_TRUE(previous.open(QFile::WriteOnly));
+        previous.write("previous");
+    }
+    task_.sql = QStringLiteral("SELECT * FROM missing WHERE ? < ?");
+    task_.partitions = 3;
+    EXPECT_FALSE(SavePartitioned(task_));
+    EXPECT_EQ(ReadFile(task_.file_name), "previous");
+}
+}  // namespace
+}  // namespace outfit::utils::csv
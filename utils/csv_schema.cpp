@@ -0,0 +1,62 @@
+#include "csv_schema.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSqlField>
+#include <QStringLiteral>
+
+namespace outfit::utils::csv {
+Schema SchemaFromRecord(const QSqlRecord& record, qint64 rows) {
+    Schema schema;
+    schema.rows = rows;
+    for (int i = 0, columns = record.count(); i < columns; ++i) {
+        const QSqlField field = record.field(i);
+        schema.columns.push_back({field.name(), field.metaType()});
+    }
+    return schema;
+}
+
+QString SchemaFileName(const QString& csv_file_name) {
+    return csv_file_name + QStringLiteral(".schema.json");
+}
+
+bool WriteSchema(const QString& file_name, const Schema& schema) {
+    QJsonArray columns;
+    for (const ColumnSchema& column : schema.columns) {
+        QJsonObject json;
+        json.insert("name", column.name);
+        json.insert("type", QString::fromLatin1(column.type.name()));
+        columns.push_back(json);
+    }
+    QJsonObject json;
+    json.insert("columns", columns);
+    json.insert("rows", schema.rows);
+    QSaveFile file(file_name);
+    return file.open(QFile::WriteOnly) && file.write(QJsonDocument(json).toJson()) >= 0 &&
+           file.commit();
+}
+
+// Unknown type names are kept as an invalid QMetaType, which readers treat as text.
+std::optional<Schema> ReadSchema(const QString& file_name) {
+    QFile file(file_name);
+    if (!file.open(QFile::ReadOnly)) {
+        return std::nullopt;
+    }
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    if (!json.value("columns").isArray()) {
+        return std::nullopt;
+    }
+    Schema schema;
+    schema.rows = json.value("rows").toInteger();
+    for (const QJsonValue& value : json.value("columns").toArray()) {
+        const QJsonObject column = value.toObject();
+        schema.columns.push_back(
+            {column.value("name").toString(),
+             QMetaType::fromName(column.value("type").toString().toLatin1())});
+    }
+    return schema;
+}
+}  // namespace outfit::utils::csv
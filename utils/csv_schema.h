@@ -0,0 +1,34 @@
+#ifndef CREATIVE_CSV_SCHEMA_H
+#define CREATIVE_CSV_SCHEMA_H
+
+#include <QList>
+#include <QMetaType>
+#include <QSqlRecord>
+#include <QString>
+
+#include <optional>
+
+namespace outfit::utils::csv {
+struct ColumnSchema {
+    QString name;
+    QMetaType type;
+};
+
+// Column names and types of an exported file plus its row count, so that a loader can
+// size its buffers and pick typed parsers without scanning the data first.
+struct Schema {
+    QList<ColumnSchema> columns;
+    qint64 rows = 0;
+};
+
+Schema SchemaFromRecord(const QSqlRecord& record, qint64 rows);
+
+// "<csv file>.schema.json".
+QString SchemaFileName(const QString& csv_file_name);
+
+// The sidecar is JSON: {"columns": [{"name": ..., "type": <QMetaType name>}], "rows": ...}.
+bool WriteSchema(const QString& file_name, const Schema& schema);
+std::optional<Schema> ReadSchema(const QString& file_name);
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_SCHEMA_H
@@ -0,0 +1,382 @@
+#include "csv_writer.h"
+
+#include "escape.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QSqlError>
+#include <QSqlRecord>
+#include <QStringLiteral>
+#include <QTime>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+namespace outfit::utils::csv {
+namespace {
+constexpr qsizetype kBufferSlack = qsizetype{64} << 10;
+// Enough for any 64-bit integer and the shortest round-trip form of a double.
+constexpr qsizetype kMaxNumberChars = 32;
+constexpr qsizetype kDateChars = 10;
+constexpr qsizetype kTimeChars = 12;
+constexpr int kMaxIsoYear = 9999;
+
+char* WriteDigits(char* out, int value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return out + width;
+}
+
+char* WriteDate(char* out, QDate date) {
+    out = WriteDigits(out, date.year(), 4);
+    *out++ = '-';
+    out = WriteDigits(out, date.month(), 2);
+    *out++ = '-';
+    return WriteDigits(out, date.day(), 2);
+}
+
+char* WriteTime(char* out, QTime time) {
+    out = WriteDigits(out, time.hour(), 2);
+    *out++ = ':';
+    out = WriteDigits(out, time.minute(), 2);
+    *out++ = ':';
+    out = WriteDigits(out, time.second(), 2);
+    *out++ = '.';
+    return WriteDigits(out, time.msec(), 3);
+}
+}  // namespace
+
+// A batch normally fits in the first arena block and goes out in a single write.
+template <class D>
+BasicWriter<D>::BasicWriter(QIODevice& device, WriterOptions options)
+    : device_(device)
+    , options_(std::move(options))
+    , arena_(static_cast<std::size_t>(options_.flush_threshold + kBufferSlack)) {
+    options_.batch_size = std::max(options_.batch_size, 1);
+}
+
+// After a failed or cancelled export the buffered tail is dropped rather than appended to
+// a file the caller is about to discard or retry.
+template <class D>
+BasicWriter<D>::~BasicWriter() {
+    if (!failed_) {
+        Flush();
+    }
+}
+
+template <class D>
+void BasicWriter<D>::WriteHeader(const QString& header) {
+    AppendUtf8(header);
+    AppendLineEnding();
+}
+
+template <class D>
+ExportResult BasicWriter<D>::WriteQuery(QSqlQuery& query) {
+    query.setForwardOnly(true);
+    if (!query.exec()) {
+        return Fail(ExportStatus::kQueryFailed, query.lastError().text());
+    }
+    const QSqlRecord record = query.record();
+    formatters_.clear();
+    for (int i = 0, columns = record.count(); i < columns; ++i) {
+        formatters_.push_back(ChooseFormatter(record.field(i).metaType()));
+    }
+    if (options_.header_from_record) {
+        for (int i = 0, columns = record.count(); i < columns; ++i) {
+            if (i > 0) {
+                AppendChar(D::kDelimiter);
+            }
+            AppendField(record.fieldName(i));
+        }
+        AppendLineEnding();
+    }
+    int fetched = options_.batch_size;
+    while (fetched == options_.batch_size) {
+        fetched = 0;
+        while (fetched < options_.batch_size && query.next()) {
+            AppendRow(query);
+            ++fetched;
+        }
+        rows_ += fetched;
+        if (arena_.Size() >= static_cast<std::size_t>(options_.flush_threshold) && !Flush()) {
+            return Fail(ExportStatus::kWriteFailed, device_.errorString());
+        }
+        if (options_.on_batch && !options_.on_batch(RowsWritten(), BytesWritten())) {
+            return Fail(ExportStatus::kCancelled, QStringLiteral("export cancelled"));
+        }
+    }
+    if (!Flush()) {
+        return Fail(ExportStatus::kWriteFailed, device_.errorString());
+    }
+    return Result(ExportStatus::kOk);
+}
+
+template <class D>
+bool BasicWriter<D>::Flush() {
+    const bool written = arena_.ForEachBlock([this](const char* data, std::size_t size) {
+        const auto bytes = static_cast<qint64>(size);
+        if (device_.write(data, bytes) != bytes) {
+            return false;
+        }
+        bytes_ += bytes;
+        return true;
+    });
+    if (written) {
+        arena_.Reset();
+    }
+    return written;
+}
+
+template <class D>
+ExportResult BasicWriter<D>::Result(ExportStatus status, const QString& error) const {
+    return {status, error, RowsWritten(), BytesWritten()};
+}
+
+template <class D>
+ExportResult BasicWriter<D>::Fail(ExportStatus status, const QString& error) {
+    failed_ = true;
+    return Result(status, error);
+}
+
+template <class D>
+qint64 BasicWriter<D>::RowsWritten() const {
+    return rows_;
+}
+
+template <class D>
+qint64 BasicWriter<D>::BytesWritten() const {
+    return bytes_ + static_cast<qint64>(arena_.Size());
+}
+
+template <class D>
+const QVariant& BasicWriter<D>::Mark() const {
+    return mark_;
+}
+
+template <class D>
+qint64 BasicWriter<D>::GenericCells() const {
+    return generic_cells_;
+}
+
+template <class D>
+typename BasicWriter<D>::Formatter BasicWriter<D>::ChooseFormatter(QMetaType type) {
+    switch (type.id()) {
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+            return &BasicWriter::AppendInteger;
+#if defined(__cpp_lib_to_chars)
+        case QMetaType::Double:
+            return &BasicWriter::template AppendNumber<double>;
+        case QMetaType::Float:
+            return &BasicWriter::template AppendNumber<float>;
+#endif
+        case QMetaType::Bool:
+            return &BasicWriter::AppendBool;
+        case QMetaType::QString:
+            return &BasicWriter::AppendString;
+        case QMetaType::QDate:
+            return &BasicWriter::AppendDate;
+        case QMetaType::QTime:
+            return &BasicWriter::AppendTime;
+        case QMetaType::QDateTime:
+            return &BasicWriter::AppendDateTime;
+        default:
+            return &BasicWriter::AppendGeneric;
+    }
+}
+
+// Drivers may hand out a different type than the field declares (SQLite stores values
+// dynamically), so every typed formatter checks the cell before taking its fast path.
+// Integer columns share one formatter that dispatches on the cell: QSQLITE declares INTEGER
+// columns as Int but reads every cell with sqlite3_column_int64, as a qlonglong.
+template <class D>
+void BasicWriter<D>::AppendInteger(const QVariant& value) {
+    switch (value.metaType().id()) {
+        case QMetaType::Int:
+            AppendNumber<int>(value);
+            break;
+        case QMetaType::UInt:
+            AppendNumber<uint>(value);
+            break;
+        case QMetaType::LongLong:
+            AppendNumber<qlonglong>(value);
+            break;
+        case QMetaType::ULongLong:
+            AppendNumber<qulonglong>(value);
+            break;
+        default:
+            AppendGeneric(value);
+            break;
+    }
+}
+
+template <class D>
+template <class T>
+void BasicWriter<D>::AppendNumber(const QVariant& value) {
+    if (value.metaType() != QMetaType::fromType<T>()) {
+        AppendGeneric(value);
+        return;
+    }
+    char* out = Reserve(kMaxNumberChars);
+    Commit(std::to_chars(out, out + kMaxNumberChars, *static_cast<const T*>(value.constData()))
+               .ptr);
+}
+
+template <class D>
+void BasicWriter<D>::AppendBool(const QVariant& value) {
+    if (value.metaType() != QMetaType::fromType<bool>()) {
+        AppendGeneric(value);
+        return;
+    }
+    const std::string_view text = *static_cast<const bool*>(value.constData()) ? "true" : "false";
+    char* out = Reserve(static_cast<qsizetype>(text.size()));
+    Commit(std::copy(text.begin(), text.end(), out));
+}
+
+template <class D>
+void BasicWriter<D>::AppendString(const QVariant& value) {
+    if (value.metaType() != QMetaType::fromType<QString>()) {
+        AppendGeneric(value);
+        return;
+    }
+    AppendField(*static_cast<const QString*>(value.constData()));
+}
+
+// The fast paths below produce the same text as QVariant::toString(), which uses
+// Qt::ISODate for dates and Qt::ISODateWithMs for times and local date-times.
+template <class D>
+void BasicWriter<D>::AppendDate(const QVariant& value) {
+    if (value.metaType() != QMetaType::fromType<QDate>()) {
+        AppendGeneric(value);
+        return;
+    }
+    const QDate& date = *static_cast<const QDate*>(value.constData());
+    if (!date.isValid() || date.year() < 0 || date.year() > kMaxIsoYear) {
+        AppendGeneric(value);
+        return;
+    }
+    Commit(WriteDate(Reserve(kDateChars), date));
+}
+
+template <class D>
+void BasicWriter<D>::AppendTime(const QVariant& value) {
+    if (value.metaType() != QMetaType::fromType<QTime>()) {
+        AppendGeneric(value);
+        return;
+    }
+    const QTime& time = *static_cast<const QTime*>(value.constData());
+    if (!time.isValid()) {
+        AppendGeneric(value);
+        return;
+    }
+    Commit(WriteTime(Reserve(kTimeChars), time));
+}
+
+template <class D>
+void BasicWriter<D>::AppendDateTime(const QVariant& value) {
+    if (value.metaType() != QMetaType::fromType<QDateTime>()) {
+        AppendGeneric(value);
+        return;
+    }
+    const QDateTime& date_time = *static_cast<const QDateTime*>(value.constData());
+    const QDate date = date_time.date();
+    const Qt::TimeSpec spec = date_time.timeSpec();
+    if (!date_time.isValid() || (spec != Qt::LocalTime && spec != Qt::UTC) || date.year() < 0 ||
+        date.year() > kMaxIsoYear) {
+        AppendGeneric(value);
+        return;
+    }
+    char* out = WriteDate(Reserve(kDateChars + kTimeChars + 2), date);
+    *out++ = 'T';
+    out = WriteTime(out, date_time.time());
+    if (spec == Qt::UTC) {
+        *out++ = 'Z';
+    }
+    Commit(out);
+}
+
+template <class D>
+void BasicWriter<D>::AppendGeneric(const QVariant& value) {
+    ++generic_cells_;
+    AppendField(value.toString());
+}
+
+template <class D>
+void BasicWriter<D>::AppendRow(const QSqlQuery& query) {
+    for (int i = 0, columns = static_cast<int>(formatters_.size()); i < columns; ++i) {
+        if (i > 0) {
+            AppendChar(D::kDelimiter);
+        }
+        const QVariant value = query.value(i);
+        if (!value.isNull()) {
+            (this->*formatters_[i])(value);
+        }
+        if (i == options_.mark_column) {
+            mark_ = value;
+        }
+    }
+    AppendLineEnding();
+}
+
+// The field is encoded into a reservation large enough for its escaped form, so escaping
+// never has to move it.
+template <class D>
+void BasicWriter<D>::AppendField(QStringView text) {
+    const auto max_size = static_cast<std::size_t>(encoder_.requiredSpace(text.size()));
+    char* field = arena_.Reserve(EscapedSizeBound(max_size));
+    char* end = encoder_.appendToBuffer(field, text);
+    const auto size = static_cast<std::size_t>(end - field);
+    if (const std::size_t first_special = FindSpecial<D::kDelimiter, D::kQuote>(field, size);
+        first_special != size) {
+        end = field + EscapeInPlace<D::kQuote>(field, size, first_special);
+    }
+    arena_.Commit(end);
+}
+
+template <class D>
+void BasicWriter<D>::AppendUtf8(QStringView text) {
+    char* out = Reserve(encoder_.requiredSpace(text.size()));
+    Commit(encoder_.appendToBuffer(out, text));
+}
+
+template <class D>
+void BasicWriter<D>::AppendChar(char c) {
+    arena_.Append(c);
+}
+
+template <class D>
+void BasicWriter<D>::AppendLineEnding() {
+    if constexpr (D::kLineEnding.size() == 1) {
+        arena_.Append(D::kLineEnding.front());
+    } else {
+        char* out = Reserve(static_cast<qsizetype>(D::kLineEnding.size()));
+        Commit(std::copy(D::kLineEnding.begin(), D::kLineEnding.end(), out));
+    }
+}
+
+template <class D>
+char* BasicWriter<D>::Reserve(qsizetype count) {
+    return arena_.Reserve(static_cast<std::size_t>(count));
+}
+
+template <class D>
+void BasicWriter<D>::Commit(const char* end) {
+    arena_.Commit(end);
+}
+
+template class BasicWriter<CommaDialect>;
+template class BasicWriter<TabDialect>;
+template class BasicWriter<SemicolonDialect>;
+template class BasicWriter<PipeDialect>;
+template class BasicWriter<CrLf<CommaDialect>>;
+template class BasicWriter<CrLf<TabDialect>>;
+template class BasicWriter<CrLf<SemicolonDialect>>;
+template class BasicWriter<CrLf<PipeDialect>>;
+}  // namespace outfit::utils::csv
@@ -0,0 +1,122 @@
+#ifndef CREATIVE_CSV_WRITER_H
+#define CREATIVE_CSV_WRITER_H
+
+#include "arena.h"
+#include "csv.h"
+#include "dialect.h"
+
+#include <QIODevice>
+#include <QMetaType>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringEncoder>
+#include <QStringView>
+#include <QVariant>
+
+#include <functional>
+#include <vector>
+
+namespace outfit::utils::csv {
+struct WriterOptions {
+    // Rows formatted between two looks at the buffer size; values below 1 mean 1.
+    int batch_size = 1024;
+    // Buffered bytes after which the block is handed to the device.
+    qsizetype flush_threshold = qsizetype{1} << 20;
+    // Called after every batch with the rows and bytes written so far; returning false
+    // cancels the export.
+    std::function<bool(qint64 rows, qint64 bytes)> on_batch;
+    // Column whose value in the last written row is kept for Mark(); -1 keeps nothing.
+    int mark_column = -1;
+    // Writes the query's field names as the header row once it has been executed.
+    bool header_from_record = false;
+};
+
+// Formats query results straight into a reusable UTF-8 arena and writes it to the device
+// in large blocks. The dialect is fixed at compile time, so the delimiter, quote and line
+// ending are constants in the formatting and escaping loops; the dialects in dialect.h are
+// instantiated in csv_writer.cpp.
+template <class D>
+class BasicWriter {
+   public:
+    explicit BasicWriter(QIODevice& device, WriterOptions options = {});
+
+    BasicWriter(const BasicWriter&) = delete;
+    BasicWriter& operator=(const BasicWriter&) = delete;
+    BasicWriter(BasicWriter&&) = delete;
+    BasicWriter& operator=(BasicWriter&&) = delete;
+
+    ~BasicWriter();
+
+    // Writes header verbatim, followed by the line ending; it must already use D's delimiter
+    // and quoting.
+    void WriteHeader(const QString& header);
+
+    // Executes the query forward-only, writes all of its rows and flushes the buffer.
+    ExportResult WriteQuery(QSqlQuery& query);
+
+    bool Flush();
+
+    [[nodiscard]] ExportResult Result(ExportStatus status, const QString& error = {}) const;
+
+    [[nodiscard]] qint64 RowsWritten() const;
+    [[nodiscard]] qint64 BytesWritten() const;
+
+    // Value of WriterOptions::mark_column in the last row written, e.g. a high-water mark.
+    [[nodiscard]] const QVariant& Mark() const;
+
+    // Non-null cells that missed the typed fast paths and went through QVariant::toString().
+    [[nodiscard]] qint64 GenericCells() const;
+
+   private:
+    // Formats one non-null cell; picked per column from the record's field types.
+    using Formatter = void (BasicWriter::*)(const QVariant& value);
+
+    static Formatter ChooseFormatter(QMetaType type);
+
+    // Result of a failed WriteQuery; the destructor then no longer flushes.
+    ExportResult Fail(ExportStatus status, const QString& error);
+
+    void AppendInteger(const QVariant& value);
+    template <class T>
+    void AppendNumber(const QVariant& value);
+    void AppendBool(const QVariant& value);
+    void AppendString(const QVariant& value);
+    void AppendDate(const QVariant& value);
+    void AppendTime(const QVariant& value);
+    void AppendDateTime(const QVariant& value);
+    void AppendGeneric(const QVariant& value);
+
+    void AppendRow(const QSqlQuery& query);
+    void AppendField(QStringView text);
+    void AppendUtf8(QStringView text);
+    void AppendChar(char c);
+    void AppendLineEnding();
+
+    char* Reserve(qsizetype count);
+    void Commit(const char* end);
+
+    QIODevice& device_;
+    WriterOptions options_;
+    Arena arena_;
+    QStringEncoder encoder_{QStringEncoder::Utf8};
+    std::vector<Formatter> formatters_;
+    QVariant mark_;
+    qint64 rows_ = 0;
+    qint64 bytes_ = 0;
+    qint64 generic_cells_ = 0;
+    bool failed_ = false;
+};
+
+extern template class BasicWriter<CommaDialect>;
+extern template class BasicWriter<TabDialect>;
+extern template class BasicWriter<SemicolonDialect>;
+extern template class BasicWriter<PipeDialect>;
+extern template class BasicWriter<CrLf<CommaDialect>>;
+extern template class BasicWriter<CrLf<TabDialect>>;
+extern template class BasicWriter<CrLf<SemicolonDialect>>;
+extern template class BasicWriter<CrLf<PipeDialect>>;
+
+using Writer = BasicWriter<CommaDialect>;
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_WRITER_H
@@ -0,0 +1,101 @@
+#include "csv_writer.h"
+
+#include "test_database.h"
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QSqlQuery>
+
+#include <utility>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::csv {
+namespace {
+class WriterTest : public testing::Test {
+   protected:
+    QByteArray Export(const QString& sql, WriterOptions options = {}) {
+        QBuffer buffer;
+        buffer.open(QBuffer::WriteOnly);
+        {
+            Writer writer(buffer, std::move(options));
+            QSqlQuery query(db_.Db());
+            query.prepare(sql);
+            result_ = writer.WriteQuery(query);
+            generic_cells_ = writer.GenericCells();
+        }
+        return buffer.data();
+    }
+
+    TestDatabase db_;
+    ExportResult result_;
+    qint64 generic_cells_ = 0;
+};
+
+// QSQLITE declares INTEGER columns as Int and returns their cells as qlonglong; both must
+// take the integer fast path.
+TEST_F(WriterTest, SqliteIntegersTakeTheFastPath) {
+    db_.Exec("CREATE TABLE numbers (id INTEGER, quantity INTEGER)");
+    db_.Exec(
+        "INSERT INTO numbers VALUES (1, 10), (2, NULL), (-9223372036854775808, "
+        "9223372036854775807)");
+    EXPECT_EQ(
+        Export("SELECT * FROM numbers ORDER BY rowid"),
+        "1,10\n2,\n-9223372036854775808,9223372036854775807\n");
+    EXPECT_TRUE(result_);
+    EXPECT_EQ(result_.rows, 3);
+    EXPECT_EQ(generic_cells_, 0);
+}
+
+// SQLite types are advisory: text stored in an INTEGER column falls back to toString().
+TEST_F(WriterTest, MismatchedCellFallsBack) {
+    db_.Exec("CREATE TABLE numbers (id INTEGER)");
+    db_.Exec("INSERT INTO numbers VALUES (1), ('a,b')");
+    EXPECT_EQ(Export("SELECT * FROM numbers ORDER BY rowid"), "1\n\"a,b\"\n");
+    EXPECT_EQ(generic_cells_, 1);
+}
+
+TEST_F(WriterTest, HeaderFromRecordAndEscaping) {
+    db_.Exec("CREATE TABLE items (name TEXT, note TEXT)");
+    db_.Exec("INSERT INTO items VALUES ('plain', 'say \"hi\"'), ('a\nb', NULL)");
+    EXPECT_EQ(
+        Export("SELECT * FROM items ORDER BY rowid", {.header_from_record = true}),
+        "name,note\nplain,\"say \"\"hi\"\"\"\n\"a\nb\",\n");
+    EXPECT_EQ(generic_cells_, 0);
+}
+
+TEST_F(WriterTest, FailedQuery) {
+    EXPECT_EQ(Export("SELECT * FROM missing"), "");
+    EXPECT_EQ(result_.status, ExportStatus::kQueryFailed);
+}
+
+// Batch sizes below 1 are taken as 1 instead of never finishing the first batch.
+TEST_F(WriterTest, NonPositiveBatchSize) {
+    db_.Exec("CREATE TABLE numbers (id INTEGER)");
+    db_.Exec("INSERT INTO numbers VALUES (1), (2), (3)");
+    for (const int batch_size : {0, -5}) {
+        int batches = 0;
+        WriterOptions options{.batch_size = batch_size};
+        options.on_batch = [&batches](qint64 /*rows*/, qint64 /*bytes*/) {
+            ++batches;
+            return true;
+        };
+        EXPECT_EQ(Export("SELECT * FROM numbers ORDER BY id", std::move(options)), "1\n2\n3\n");
+        EXPECT_TRUE(result_);
+        // One batch per row and a last, empty one.
+        EXPECT_EQ(batches, 4) << batch_size;
+    }
+}
+
+// A cancelled export leaves what is still buffered unwritten.
+TEST_F(WriterTest, CancelDropsBufferedRows) {
+    db_.Exec("CREATE TABLE numbers (id INTEGER)");
+    db_.Exec("INSERT INTO numbers VALUES (1), (2), (3)");
+    WriterOptions options{.batch_size = 2};
+    options.on_batch = [](qint64 /*rows*/, qint64 /*bytes*/) { return false; };
+    EXPECT_EQ(Export("SELECT * FROM numbers ORDER BY id", std::move(options)), "");
+    EXPECT_EQ(result_.status, ExportStatus::kCancelled);
+    EXPECT_EQ(result_.rows, 2);
+}
+}  // namespace
+}  // namespace outfit::utils::csv
@@ -0,0 +1,27 @@
+#ifndef CREATIVE_DIALECT_H
+#define CREATIVE_DIALECT_H
+
+#include <string_view>
+
+namespace outfit::utils::csv {
+enum class LineEnding { kLf, kCrLf };
+
+// Compile-time description of a delimited text format. Writers and escaping kernels are
+// specialized per dialect, so their inner loops compare against constants.
+template <char Delimiter, char Quote = '"', LineEnding Ending = LineEnding::kLf>
+struct Dialect {
+    static constexpr char kDelimiter = Delimiter;
+    static constexpr char kQuote = Quote;
+    static constexpr std::string_view kLineEnding = Ending == LineEnding::kCrLf ? "\r\n" : "\n";
+};
+
+using CommaDialect = Dialect<','>;
+using TabDialect = Dialect<'\t'>;
+using SemicolonDialect = Dialect<';'>;
+using PipeDialect = Dialect<'|'>;
+
+template <class D>
+using CrLf = Dialect<D::kDelimiter, D::kQuote, LineEnding::kCrLf>;
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_DIALECT_H
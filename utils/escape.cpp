@@ -0,0 +1,151 @@
+#include "escape.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CREATIVE_ESCAPE_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CREATIVE_ESCAPE_NEON 1
+#endif
+
+namespace outfit::utils::csv {
+namespace {
+template <char Delimiter, char Quote, class Char>
+constexpr bool IsSpecial(Char c) {
+    return c == Delimiter || c == Quote || c == '\r' || c == '\n';
+}
+
+template <char Delimiter, char Quote, class Char>
+std::size_t FindSpecialScalar(const Char* data, std::size_t from, std::size_t size) {
+    for (auto i = from; i < size; ++i) {
+        if (IsSpecial<Delimiter, Quote>(data[i])) {
+            return i;
+        }
+    }
+    return size;
+}
+}  // namespace
+
+template <char Delimiter, char Quote>
+std::size_t FindSpecial(const char* data, std::size_t size) {
+    std::size_t i = 0;
+#if CREATIVE_ESCAPE_SSE2
+    const __m128i delimiter = _mm_set1_epi8(Delimiter);
+    const __m128i quote = _mm_set1_epi8(Quote);
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, delimiter), _mm_cmpeq_epi8(chunk, quote)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+        if (const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits)); mask != 0) {
+            return i + std::countr_zero(mask);
+        }
+    }
+#elif CREATIVE_ESCAPE_NEON
+    const uint8x16_t delimiter = vdupq_n_u8(Delimiter);
+    const uint8x16_t quote = vdupq_n_u8(Quote);
+    const uint8x16_t cr = vdupq_n_u8('\r');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        const uint8x16_t hits = vorrq_u8(
+            vorrq_u8(vceqq_u8(chunk, delimiter), vceqq_u8(chunk, quote)),
+            vorrq_u8(vceqq_u8(chunk, cr), vceqq_u8(chunk, lf)));
+        // Narrowing shift packs the byte mask into 4 bits per byte.
+        const uint8x8_t packed = vshrn_n_u16(vreinterpretq_u16_u8(hits), 4);
+        if (const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(packed), 0); mask != 0) {
+            return i + std::countr_zero(mask) / 4;
+        }
+    }
+#endif
+    return FindSpecialScalar<Delimiter, Quote>(data, i, size);
+}
+
+std::size_t FindSpecial(const char* data, std::size_t size) {
+    return FindSpecial<',', '"'>(data, size);
+}
+
+std::size_t FindSpecial(const char16_t* data, std::size_t size) {
+    std::size_t i = 0;
+#if CREATIVE_ESCAPE_SSE2
+    const __m128i comma = _mm_set1_epi16(',');
+    const __m128i quote = _mm_set1_epi16('"');
+    const __m128i cr = _mm_set1_epi16('\r');
+    const __m128i lf = _mm_set1_epi16('\n');
+    for (; i + 8 <= size; i += 8) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi16(chunk, comma), _mm_cmpeq_epi16(chunk, quote)),
+            _mm_or_si128(_mm_cmpeq_epi16(chunk, cr), _mm_cmpeq_epi16(chunk, lf)));
+        if (const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits)); mask != 0) {
+            return i + std::countr_zero(mask) / 2;
+        }
+    }
+#elif CREATIVE_ESCAPE_NEON
+    const uint16x8_t comma = vdupq_n_u16(',');
+    const uint16x8_t quote = vdupq_n_u16('"');
+    const uint16x8_t cr = vdupq_n_u16('\r');
+    const uint16x8_t lf = vdupq_n_u16('\n');
+    for (; i + 8 <= size; i += 8) {
+        const uint16x8_t chunk = vld1q_u16(reinterpret_cast<const uint16_t*>(data + i));
+        const uint16x8_t hits = vorrq_u16(
+            vorrq_u16(vceqq_u16(chunk, comma), vceqq_u16(chunk, quote)),
+            vorrq_u16(vceqq_u16(chunk, cr), vceqq_u16(chunk, lf)));
+        const uint8x8_t packed = vmovn_u16(hits);
+        if (const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(packed), 0); mask != 0) {
+            return i + std::countr_zero(mask) / 8;
+        }
+    }
+#endif
+    return FindSpecialScalar<',', '"'>(data, i, size);
+}
+
+template <char Quote>
+std::size_t EscapeInPlace(char* data, std::size_t size, std::size_t first_special) {
+    if (first_special >= size) {
+        return size;
+    }
+    const auto quotes =
+        static_cast<std::size_t>(std::count(data + first_special, data + size, Quote));
+    const std::size_t escaped_size = size + quotes + 2;
+    // Walk backwards so every byte is moved before its slot is overwritten.
+    char* out = data + escaped_size;
+    *--out = Quote;
+    for (auto i = size; i > first_special;) {
+        const char c = data[--i];
+        *--out = c;
+        if (c == Quote) {
+            *--out = Quote;
+        }
+    }
+    std::memmove(data + 1, data, first_special);
+    data[0] = Quote;
+    return escaped_size;
+}
+
+template <char Delimiter, char Quote>
+char* EscapeInto(const char* data, std::size_t size, char* out) {
+    const std::size_t first_special = FindSpecial<Delimiter, Quote>(data, size);
+    std::memcpy(out, data, size);
+    return out + EscapeInPlace<Quote>(out, size, first_special);
+}
+
+#define CREATIVE_ESCAPE_INSTANTIATE(delimiter)                                        \
+    template std::size_t FindSpecial<delimiter, '"'>(const char*, std::size_t);      \
+    template char* EscapeInto<delimiter, '"'>(const char*, std::size_t, char*)
+
+CREATIVE_ESCAPE_INSTANTIATE(',');
+CREATIVE_ESCAPE_INSTANTIATE('\t');
+CREATIVE_ESCAPE_INSTANTIATE(';');
+CREATIVE_ESCAPE_INSTANTIATE('|');
+template std::size_t EscapeInPlace<'"'>(char*, std::size_t, std::size_t);
+
+#undef CREATIVE_ESCAPE_INSTANTIATE
+}  // namespace outfit::utils::csv
@@ -0,0 +1,46 @@
+#ifndef CREATIVE_ESCAPE_H
+#define CREATIVE_ESCAPE_H
+
+#include <cstddef>
+
+namespace outfit::utils::csv {
+// Position of the first delimiter, quote, '\r' or '\n' in data, or size if there is none.
+// Scans 16 bytes per step where SSE2 or NEON is available. Instantiated for ',', '\t', ';'
+// and '|' delimiters with '"' quotes.
+template <char Delimiter, char Quote>
+std::size_t FindSpecial(const char* data, std::size_t size);
+
+// Comma-separated, double-quoted fields.
+std::size_t FindSpecial(const char* data, std::size_t size);
+std::size_t FindSpecial(const char16_t* data, std::size_t size);
+
+// Largest number of bytes a field of size bytes can take once escaped.
+constexpr std::size_t EscapedSizeBound(std::size_t size) {
+    return 2 * size + 2;
+}
+
+// Quotes the field held in data[0, size) and doubles its quotes, in place. first_special
+// is the result of FindSpecial; the buffer must have room for EscapedSizeBound(size)
+// bytes. Returns the new size of the field.
+template <char Quote = '"'>
+std::size_t EscapeInPlace(char* data, std::size_t size, std::size_t first_special);
+
+// Writes the escaped field to out, which must have room for EscapedSizeBound(size) bytes.
+// Returns the end of the written data; fields without special characters are copied as is.
+template <char Delimiter = ',', char Quote = '"'>
+char* EscapeInto(const char* data, std::size_t size, char* out);
+
+#define CREATIVE_ESCAPE_DECLARE(delimiter)                                                   \
+    extern template std::size_t FindSpecial<delimiter, '"'>(const char*, std::size_t);      \
+    extern template char* EscapeInto<delimiter, '"'>(const char*, std::size_t, char*)
+
+CREATIVE_ESCAPE_DECLARE(',');
+CREATIVE_ESCAPE_DECLARE('\t');
+CREATIVE_ESCAPE_DECLARE(';');
+CREATIVE_ESCAPE_DECLARE('|');
+extern template std::size_t EscapeInPlace<'"'>(char*, std::size_t, std::size_t);
+
+#undef CREATIVE_ESCAPE_DECLARE
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_ESCAPE_H
@@ -0,0 +1,126 @@
+#include "escape.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::csv {
+namespace {
+// The SIMD loops take 16 bytes (8 UTF-16 units) per step and leave the rest to the scalar
+// tail, so every size up to 64 and every position of the special character is checked
+// against a plain find_first_of.
+constexpr std::size_t kMaxSize = 64;
+
+// Filler that covers bytes next to the special characters and bytes with the top bit set.
+std::string Filler(std::size_t size) {
+    constexpr std::string_view kChars = "ab\x01\x0b\x0c\x0e!#+-:{}\x7f\x80\xa2\xff";
+    std::string text(size, ' ');
+    for (std::size_t i = 0; i < size; ++i) {
+        text[i] = kChars[(i * 7 + size) % kChars.size()];
+    }
+    return text;
+}
+
+template <char Delimiter>
+std::size_t NaiveFind(std::string_view text) {
+    const char specials[] = {Delimiter, '"', '\r', '\n'};
+    return std::min(text.find_first_of(std::string_view{specials, 4}), text.size());
+}
+
+std::string NaiveEscape(std::string_view text, std::size_t first_special) {
+    if (first_special >= text.size()) {
+        return std::string{text};
+    }
+    std::string escaped = "\"";
+    for (const char c : text) {
+        escaped += c;
+        if (c == '"') {
+            escaped += '"';
+        }
+    }
+    return escaped + '"';
+}
+
+template <char Delimiter>
+void Check(const std::string& text) {
+    SCOPED_TRACE(testing::Message() << "delimiter " << static_cast<int>(Delimiter) << " size "
+                                    << text.size() << " text " << testing::PrintToString(text));
+    const std::size_t expected = NaiveFind<Delimiter>(text);
+    ASSERT_EQ((FindSpecial<Delimiter, '"'>(text.data(), text.size())), expected);
+    if constexpr (Delimiter == ',') {
+        ASSERT_EQ(FindSpecial(text.data(), text.size()), expected);
+    }
+    const std::string escaped = NaiveEscape(text, expected);
+
+    std::string out(EscapedSizeBound(text.size()), '\0');
+    char* end = EscapeInto<Delimiter, '"'>(text.data(), text.size(), out.data());
+    ASSERT_EQ(std::string_view(out.data(), end - out.data()), escaped);
+
+    std::string in_place = text;
+    in_place.resize(EscapedSizeBound(text.size()));
+    const std::size_t size = EscapeInPlace(in_place.data(), text.size(), expected);
+    ASSERT_EQ(std::string_view(in_place.data(), size), escaped);
+}
+
+template <char Delimiter>
+void CheckAllPositions() {
+    // The other delimiters must not count as specials.
+    constexpr char kSpecials[] = {Delimiter, '"', '\r', '\n', ',', '\t', ';', '|'};
+    for (std::size_t size = 0; size <= kMaxSize; ++size) {
+        const std::string filler = Filler(size);
+        Check<Delimiter>(filler);
+        for (std::size_t pos = 0; pos < size; ++pos) {
+            for (const char special : kSpecials) {
+                std::string text = filler;
+                text[pos] = special;
+                Check<Delimiter>(text);
+                // A second special later in the text must not hide the first one.
+                if (pos + 1 < size) {
+                    text[size - 1] = '"';
+                    Check<Delimiter>(text);
+                }
+            }
+        }
+    }
+}
+
+TEST(EscapeTest, Comma) {
+    CheckAllPositions<','>();
+}
+
+TEST(EscapeTest, Tab) {
+    CheckAllPositions<'\t'>();
+}
+
+TEST(EscapeTest, Semicolon) {
+    CheckAllPositions<';'>();
+}
+
+TEST(EscapeTest, Pipe) {
+    CheckAllPositions<'|'>();
+}
+
+TEST(EscapeTest, Utf16) {
+    // Units whose low or high byte equals a special character must not match.
+    constexpr std::u16string_view kChars = u"abĬⰀഊ∍ÿ中Ģ";
+    constexpr char16_t kSpecials[] = {u',', u'"', u'\r', u'\n'};
+    for (std::size_t size = 0; size <= kMaxSize; ++size) {
+        std::u16string filler(size, u' ');
+        for (std::size_t i = 0; i < size; ++i) {
+            filler[i] = kChars[(i * 5 + size) % kChars.size()];
+        }
+        ASSERT_EQ(FindSpecial(filler.data(), filler.size()), size);
+        for (std::size_t pos = 0; pos < size; ++pos) {
+            for (const char16_t special : kSpecials) {
+                std::u16string text = filler;
+                text[pos] = special;
+                ASSERT_EQ(FindSpecial(text.data(), text.size()), pos)
+                    << "size " << size << " special " << static_cast<int>(special);
+            }
+        }
+    }
+}
+}  // namespace
+}  // namespace outfit::utils::csv
@@ -0,0 +1,62 @@
+#ifndef CREATIVE_TEST_DATABASE_H
+#define CREATIVE_TEST_DATABASE_H
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringLiteral>
+#include <QTemporaryDir>
+#include <QUuid>
+
+#include <gtest/gtest.h>
+
+namespace outfit::utils::csv {
+// SQLite database in a temporary directory. It is a file rather than ":memory:" so that the
+// exports that clone the connection on worker threads see the same data.
+class TestDatabase {
+   public:
+    TestDatabase()
+        : connection_(QStringLiteral("test_%1").arg(QUuid::createUuid().toString(QUuid::Id128))) {
+        db_ = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connection_);
+        db_.setDatabaseName(Path(QStringLiteral("test.db")));
+        EXPECT_TRUE(db_.open()) << db_.lastError().text().toStdString();
+    }
+
+    TestDatabase(const TestDatabase&) = delete;
+    TestDatabase& operator=(const TestDatabase&) = delete;
+    TestDatabase(TestDatabase&&) = delete;
+    TestDatabase& operator=(TestDatabase&&) = delete;
+
+    ~TestDatabase() {
+        db_.close();
+        db_ = {};
+        QSqlDatabase::removeDatabase(connection_);
+    }
+
+    QSqlDatabase& Db() {
+        return db_;
+    }
+
+    [[nodiscard]] const QString& ConnectionName() const {
+        return connection_;
+    }
+
+    // Path of a file in the temporary directory.
+    [[nodiscard]] QString Path(const QString& name) const {
+        return dir_.filePath(name);
+    }
+
+    void Exec(const QString& sql) {
+        QSqlQuery query(db_);
+        EXPECT_TRUE(query.exec(sql)) << query.lastError().text().toStdString();
+    }
+
+   private:
+    QTemporaryDir dir_;
+    QString connection_;
+    QSqlDatabase db_;
+};
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_TEST_DATABASE_H